@@ -0,0 +1,195 @@
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include <chrono>
+#include <cstdlib>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "engine2.hpp"
+
+using namespace cechess;
+
+// =========================
+// Analyse en série d'un fichier EPD/FEN
+// =========================
+// Une position par ligne (FEN complet ou EPD avec opcodes) ; chaque ligne
+// de sortie : <fen>;bm <coup>;cp <score>;depth <d>;nodes <n>
+// suivie, avec --multipv N, de ;pv2 <coup> <score> ... ;pvN <coup> <score>
+// Un mat s'écrit "mate N" comme en UCI (N<0 : on est maté) : ";mate 3",
+// ";pv2 <coup> mate -2". Sans coup légal : ";bm 0000;mate 0" (mat) ou
+// ";bm 0000;cp 0" (pat), à profondeur 0, sans recherche.
+// Les positions sont réparties entre 'workers' moteurs indépendants ;
+// la sortie garde l'ordre du fichier (traitement par blocs).
+
+struct BatchOptions {
+    SearchLimits limits;
+    int workers = 1;          // positions analysées en parallèle
+    int threads = 1;          // threads Lazy SMP par worker
+    int hashMb = TT_DEFAULT_MB;
+    bool sharedHash = false;  // une seule TT de 'hashMb' pour tous les workers
+    bool clearHash = false;   // positions indépendantes : TT vidée entre chaque
+    std::string in, out, nnue; // nnue : fichier réseau (éval NNUE au lieu de la classique)
+    std::string syzygy;        // répertoire(s) des tables de finales
+};
+
+struct BatchResult {
+    bool ok = false;
+    std::string fen;
+    int best = 0, depth = 0;
+    std::string score;                               // "cp <n>" ou "mate <n>"
+    U64 nodes = 0;
+    std::vector<std::pair<int, std::string>> others; // MultiPV : (coup, score) des lignes 2..N
+};
+
+static std::string score_text(int cp, int mate) {
+    return mate ? "mate " + std::to_string(mate) : "cp " + std::to_string(cp);
+}
+
+constexpr size_t BATCH_CHUNK = 1024;
+
+static void usage() {
+    std::cout << "Usage: analyse <input.epd> [--out file] [--depth N] [--nodes N] [--movetime ms]\n"
+                 "               [--workers N] [--threads N] [--hash MB] [--shared-hash] [--clear]\n"
+                 "               [--nnue file] [--syzygy path] [--multipv N]\n"
+                 "  sans limite : --depth 8 ; --workers 0 = un par coeur\n"
+                 "  --hash : par worker, ou total avec --shared-hash\n";
+}
+
+static void analyse_one(Engine &e, const BatchOptions &opt, const std::string &line, BatchResult &r) {
+    Position p;
+    if (!set_fen(p, line)) return;
+
+    // chaque position est une "partie" à part : pas d'historique de répétitions
+    set_history(e, &p.key, 1);
+    if (opt.clearHash && !opt.sharedHash) tt_clear(*e.tt);
+    r.fen = get_fen(p);
+
+    // mat ou pat : rien à chercher, la recherche renverrait -INF
+    int moves[256];
+    if (generate_legal_moves(p, moves) == 0) {
+        r.score = in_check(p, p.stm) ? "mate 0" : "cp 0";
+        r.ok = true;
+        return;
+    }
+
+    e.stop = false;
+    int cp = search_best_move(e, p, opt.limits, r.best);
+    r.score = score_text(cp, e.last.mate);
+    r.nodes = get_nodes(e);
+    for (auto &t : e.pool) r.depth = std::max(r.depth, t->completed_depth);
+    for (size_t k = 1; k < e.lines.size(); ++k)
+        r.others.push_back({e.lines[k].pv[0], e.lines[k].mate ? score_text(0, e.lines[k].mate)
+                                                               : std::to_string(e.lines[k].score)});
+    r.ok = true;
+}
+
+int main(int argc, char **argv) {
+    BatchOptions opt;
+    bool limited = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        bool hasArg = i + 1 < argc;
+        if      (a == "--depth"    && hasArg) { opt.limits.depth   = std::atoi(argv[++i]); limited = true; }
+        else if (a == "--nodes"    && hasArg) { opt.limits.nodes   = std::strtoull(argv[++i], nullptr, 10); limited = true; }
+        else if (a == "--movetime" && hasArg) { opt.limits.time_ms = std::atoi(argv[++i]); limited = true; }
+        else if (a == "--workers"  && hasArg) opt.workers = std::atoi(argv[++i]);
+        else if (a == "--threads"  && hasArg) opt.threads = std::atoi(argv[++i]);
+        else if (a == "--hash"     && hasArg) opt.hashMb  = std::atoi(argv[++i]);
+        else if (a == "--out"      && hasArg) opt.out = argv[++i];
+        else if (a == "--nnue"     && hasArg) opt.nnue = argv[++i];
+        else if (a == "--syzygy"   && hasArg) opt.syzygy = argv[++i];
+        else if (a == "--multipv"  && hasArg) opt.limits.multipv = std::atoi(argv[++i]);
+        else if (a == "--clear") opt.clearHash = true;
+        else if (a == "--shared-hash") opt.sharedHash = true;
+        else if (a == "-h" || a == "--help") { usage(); return 0; }
+        else if (opt.in.empty() && a[0] != '-') opt.in = a;
+        else { usage(); return 1; }
+    }
+    if (opt.in.empty()) { usage(); return 1; }
+    if (!limited) opt.limits.depth = 8;
+    if (!opt.syzygy.empty() && !syzygy_init(opt.syzygy))
+        std::cerr << "Syzygy unavailable (build with -DUSE_SYZYGY), ignoring " << opt.syzygy << "\n";
+    if (!opt.nnue.empty() && !(nnue_load(opt.nnue) && set_eval_backend(true))) {
+        std::cerr << "Cannot load network " << opt.nnue << "\n";
+        return 1;
+    }
+
+    std::ifstream in(opt.in);
+    if (!in) {
+        std::cerr << "Cannot open " << opt.in << "\n";
+        return 1;
+    }
+    std::ofstream fout;
+    if (!opt.out.empty()) fout.open(opt.out);
+    std::ostream &out = opt.out.empty() ? std::cout : fout;
+
+    if (opt.workers <= 0) opt.workers = (int)std::max(1u, std::thread::hardware_concurrency());
+
+    TranspositionTable shared;
+    if (opt.sharedHash) tt_resize(shared, std::max(opt.hashMb, 1));
+
+    std::vector<std::unique_ptr<Engine>> engines;
+    for (int i = 0; i < opt.workers; ++i) {
+        engines.push_back(std::make_unique<Engine>());
+        Engine &e = *engines.back();
+        if (opt.sharedHash) { e.tt = &shared; e.ages_tt = false; }
+        else tt_resize(*e.tt, std::max(opt.hashMb, 1));
+        set_threads(e, std::max(opt.threads, 1));
+    }
+
+    long long positions = 0, skipped = 0;
+    U64 totalNodes = 0;
+    auto t0 = std::chrono::steady_clock::now();
+
+    std::vector<std::string> lines;
+    std::vector<BatchResult> results;
+    std::string line;
+    bool eof = false;
+    while (!eof) {
+        lines.clear();
+        while (lines.size() < BATCH_CHUNK) {
+            if (!std::getline(in, line)) { eof = true; break; }
+            if (line.empty() || line[0] == '#') continue;
+            lines.push_back(line);
+        }
+        if (lines.empty()) break;
+
+        results.assign(lines.size(), BatchResult());
+        if (opt.sharedHash) tt_new_search(shared);
+
+        std::atomic<size_t> next{0};
+        auto work = [&](Engine &e) {
+            for (size_t i; (i = next++) < lines.size(); )
+                analyse_one(e, opt, lines[i], results[i]);
+        };
+        std::vector<std::thread> pool;
+        for (int w = 1; w < opt.workers; ++w) pool.emplace_back(work, std::ref(*engines[w]));
+        work(*engines[0]);
+        for (auto &th : pool) th.join();
+
+        for (const BatchResult &r : results) {
+            if (!r.ok) { ++skipped; continue; }
+            out << r.fen
+                << ";bm " << (r.best ? move_to_str(r.best) : "0000")
+                << ";" << r.score
+                << ";depth " << r.depth
+                << ";nodes " << r.nodes;
+            for (size_t k = 0; k < r.others.size(); ++k)
+                out << ";pv" << k + 2 << " " << move_to_str(r.others[k].first) << " " << r.others[k].second;
+            out << "\n";
+            ++positions;
+            totalNodes += r.nodes;
+        }
+    }
+    out.flush();
+
+    double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    std::cerr << "Positions " << positions
+              << "  skipped " << skipped
+              << "  time " << std::fixed << std::setprecision(3) << sec << "s"
+              << "  pos/s " << std::setprecision(1) << (sec > 0 ? positions / sec : 0.0)
+              << "  nps " << (U64)(sec > 0 ? totalNodes / sec : 0) << "\n";
+    return 0;
+}
@@ -0,0 +1,328 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <random>
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#define BOOK_MMAP 1
+#endif
+#include "engine2.hpp"
+
+namespace cechess {
+
+// =========================
+// Livre d'ouvertures (format Polyglot .bin)
+// =========================
+// Entrées de 16 octets big-endian, triées par clé :
+//   key:64 move:16 weight:16 learn:32
+// Le fichier est projeté en mémoire et lu par recherche dichotomique :
+// un livre de plusieurs Go ne coûte ni temps de chargement ni RSS.
+//
+// Clé Polyglot : xor de poly_keys[] sur
+//   64*kind + 8*rang + colonne  (kind = 2*type + 1 si blanc)
+//   768..771 roques (K Q k q), 772+colonne en passant (si une prise est
+//   possible), 780 si les blancs ont le trait.
+// La table Random64 publiée de Polyglot n'est pas recopiée ici : par défaut
+// les 781 clés sont tirées d'un générateur fixe (livres produits par
+// makebook) ; book_load_keys() charge la table officielle pour lire les
+// livres Polyglot existants. Une table chargée doit redonner les clés de
+// référence de la spécification Polyglot, sinon elle est refusée ; un livre
+// sans entrée pour la position initiale est signalé (book_has_startpos).
+
+constexpr int POLY_KEYS = 781;
+constexpr size_t BOOK_ENTRY_BYTES = 16;
+constexpr int BOOK_DEFAULT_PLY = 16;
+
+static U64 poly_keys[POLY_KEYS];
+static bool poly_keys_ready = false;
+static bool poly_keys_official = false;   // table Random64 vérifiée chargée
+
+inline void poly_default_keys(){
+    U64 x = 0x0B00C0FFEE5EEDULL;
+    for(int i=0;i<POLY_KEYS;i++){
+        // splitmix64
+        U64 z = (x += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        poly_keys[i] = z ^ (z >> 31);
+    }
+    poly_keys_ready = true;
+    poly_keys_official = false;
+}
+
+inline U64 poly_key(const Position &p);
+
+// exemples de clés de la spécification Polyglot (coups depuis la position initiale)
+struct PolyRef { const char *moves; U64 key; };
+static constexpr PolyRef POLY_REFS[] = {
+    {"",                                0x463B96181691FC9CULL},
+    {"e2e4",                            0x823C9B50FD114196ULL},
+    {"e2e4 d7d5",                       0x0756B94461C50FB0ULL},
+    {"e2e4 d7d5 e4e5",                  0x662FAFB965DB29D4ULL},
+    {"e2e4 d7d5 e4e5 f7f5",             0x22A48B5A8E47FF78ULL},   // prise en passant possible
+    {"e2e4 d7d5 e4e5 f7f5 e1e2",        0x652A607CA3F242C1ULL},
+    {"e2e4 d7d5 e4e5 f7f5 e1e2 e8f7",   0x00FDD303C946BDD9ULL},
+    {"a2a4 b7b5 h2h4 b5b4 c2c4",        0x3C8123EA7B067637ULL},
+    {"a2a4 b7b5 h2h4 b5b4 c2c4 b4c3 a1a3", 0x5C3F9B829B279560ULL},
+};
+
+// la table courante redonne-t-elle les clés de référence ?
+inline bool poly_keys_match_spec(){
+    for(const PolyRef &r : POLY_REFS){
+        Position p;
+        set_startpos(p);
+        std::istringstream is(r.moves);
+        for(std::string s; is >> s; ){
+            int m = parse_move(p, s);
+            if(!m) return false;
+            Undo u;
+            make_move(p, m, u);
+        }
+        if(poly_key(p) != r.key) return false;
+    }
+    return true;
+}
+
+// 781 valeurs hexadécimales ("0x9D39...", virgules et suffixes ULL tolérés)
+inline bool book_load_keys(const std::string &path){
+    std::ifstream in(path);
+    if(!in) return false;
+    std::ostringstream ss;
+    ss << in.rdbuf();
+    std::string text = ss.str();
+    for(char &ch : text) if(!std::isalnum((unsigned char)ch)) ch = ' ';
+
+    std::istringstream is(text);
+    std::vector<U64> keys;
+    std::string tok;
+    while(is >> tok){
+        if(tok.size() > 2 && tok[0]=='0' && (tok[1]=='x' || tok[1]=='X')) tok = tok.substr(2);
+        while(!tok.empty() && (tok.back()=='U' || tok.back()=='L' || tok.back()=='u' || tok.back()=='l')) tok.pop_back();
+        char *end = nullptr;
+        U64 v = std::strtoull(tok.c_str(), &end, 16);
+        if(tok.empty() || *end) return false;
+        keys.push_back(v);
+    }
+    if(keys.size() != POLY_KEYS) return false;
+
+    U64 old[POLY_KEYS];
+    bool oldReady = poly_keys_ready, oldOfficial = poly_keys_official;
+    std::copy(poly_keys, poly_keys + POLY_KEYS, old);
+    std::copy(keys.begin(), keys.end(), poly_keys);
+    poly_keys_ready = true;
+    if(!poly_keys_match_spec()){
+        // table incomplète, désordonnée ou d'un autre format : on garde l'ancienne
+        std::copy(old, old + POLY_KEYS, poly_keys);
+        poly_keys_ready = oldReady;
+        poly_keys_official = oldOfficial;
+        return false;
+    }
+    poly_keys_official = true;
+    return true;
+}
+
+inline U64 poly_key(const Position &p){
+    if(!poly_keys_ready) poly_default_keys();
+    U64 k = 0;
+    for(int c=0;c<2;c++)
+        for(int t=0;t<6;t++)
+            for(U64 b=pieces(p,c,t); b; ){
+                int s = pop_lsb(b);
+                int kind = 2*t + (c==WHITE ? 1 : 0);
+                k ^= poly_keys[64*kind + s];
+            }
+    for(int i=0;i<4;i++)
+        if(p.castling & (1<<i)) k ^= poly_keys[768+i];
+    // en passant : seulement si un pion du trait peut réellement prendre
+    if(p.ep != -1 && (pawn_att[p.stm^1][p.ep] & pieces(p,p.stm,PAWN)))
+        k ^= poly_keys[772 + file_of(p.ep)];
+    if(p.stm == WHITE) k ^= poly_keys[780];
+    return k;
+}
+
+// coup Polyglot : to_file:3 to_rank:3 from_file:3 from_rank:3 promo:3 (1=N..4=Q)
+// roque codé roi -> tour (e1h1, e1a1)
+inline uint16_t book_encode_move(int m){
+    int from = move_from(m), to = move_to(m);
+    if(m & MF_KSCASTLE) to = from + 3;
+    if(m & MF_QSCASTLE) to = from - 4;
+    int promo = move_is_promo(m) ? move_promo(m) : 0; // KNIGHT=1 .. QUEEN=4
+    return (uint16_t)(file_of(to) | rank_of(to)<<3 | file_of(from)<<6 | rank_of(from)<<9 | promo<<12);
+}
+
+// coup légal correspondant, 0 si aucun
+inline int book_decode_move(Position &p, uint16_t bm){
+    int to = sq(bm & 7, (bm >> 3) & 7);
+    int from = sq((bm >> 6) & 7, (bm >> 9) & 7);
+    int promo = (bm >> 12) & 7;
+    int moves[256];
+    int n = generate_legal_moves(p, moves);
+    for(int i=0;i<n;i++){
+        int m = moves[i];
+        if(move_from(m) != from) continue;
+        int mto = move_to(m);
+        if(m & MF_KSCASTLE) mto = from + 3;
+        if(m & MF_QSCASTLE) mto = from - 4;
+        if(mto != to) continue;
+        if((move_is_promo(m) ? move_promo(m) : 0) != promo) continue;
+        return m;
+    }
+    return 0;
+}
+
+struct BookEntry {
+    U64 key = 0;
+    uint16_t move = 0, weight = 0;
+    uint32_t learn = 0;
+};
+
+struct Book {
+    const unsigned char *data = nullptr;
+    size_t count = 0;                 // nombre d'entrées
+    void *map = nullptr;
+    size_t map_len = 0;
+    std::vector<unsigned char> buf;   // repli sans mmap
+    std::string path;
+
+    int max_ply = BOOK_DEFAULT_PLY;   // plus de livre à partir de ce demi-coup
+    bool best = false;                // meilleur poids au lieu d'un tirage pondéré
+    std::mt19937_64 rng{std::random_device{}()};
+
+    Book() = default;
+    Book(const Book &) = delete;
+    Book &operator=(const Book &) = delete;
+    ~Book();
+};
+
+inline void book_close(Book &b){
+#ifdef BOOK_MMAP
+    if(b.map) munmap(b.map, b.map_len);
+#endif
+    b.map = nullptr; b.map_len = 0;
+    b.buf.clear(); b.buf.shrink_to_fit();
+    b.data = nullptr; b.count = 0;
+    b.path.clear();
+}
+
+inline Book::~Book(){ book_close(*this); }
+
+static Book book;   // livre du moteur principal (main2, UCI)
+
+inline bool book_open(Book &b, const std::string &path){
+    const unsigned char *data = nullptr;
+    void *map = nullptr;
+    size_t len = 0;
+    std::vector<unsigned char> buf;
+
+#ifdef BOOK_MMAP
+    int fd = open(path.c_str(), O_RDONLY);
+    if(fd < 0) return false;
+    struct stat st;
+    if(fstat(fd, &st) != 0){ close(fd); return false; }
+    len = (size_t)st.st_size;
+    if(len < BOOK_ENTRY_BYTES || len % BOOK_ENTRY_BYTES){ close(fd); return false; }
+    map = mmap(nullptr, len, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(map == MAP_FAILED) return false;
+    madvise(map, len, MADV_RANDOM);
+    data = (const unsigned char*)map;
+#else
+    std::ifstream in(path, std::ios::binary);
+    if(!in) return false;
+    buf.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    len = buf.size();
+    if(len < BOOK_ENTRY_BYTES || len % BOOK_ENTRY_BYTES) return false;
+    data = buf.data();
+#endif
+
+    book_close(b);
+    b.map = map; b.map_len = len;
+    b.buf.swap(buf);
+    b.data  = b.buf.empty() ? data : b.buf.data();
+    b.count = len / BOOK_ENTRY_BYTES;
+    b.path  = path;
+    return true;
+}
+
+inline U64 read_be(const unsigned char *q, int bytes){
+    U64 v = 0;
+    for(int i=0;i<bytes;i++) v = v<<8 | q[i];
+    return v;
+}
+
+inline BookEntry book_entry(const Book &b, size_t i){
+    const unsigned char *q = b.data + i*BOOK_ENTRY_BYTES;
+    BookEntry e;
+    e.key    = read_be(q, 8);
+    e.move   = (uint16_t)read_be(q+8, 2);
+    e.weight = (uint16_t)read_be(q+10, 2);
+    e.learn  = (uint32_t)read_be(q+12, 4);
+    return e;
+}
+
+// toutes les entrées de la position (les clés égales sont contiguës)
+inline std::vector<BookEntry> book_entries(const Book &b, U64 key){
+    std::vector<BookEntry> out;
+    size_t lo = 0, hi = b.count;
+    while(lo < hi){
+        size_t mid = lo + (hi-lo)/2;
+        if(read_be(b.data + mid*BOOK_ENTRY_BYTES, 8) < key) lo = mid+1;
+        else hi = mid;
+    }
+    for(size_t i=lo; i<b.count; i++){
+        BookEntry e = book_entry(b, i);
+        if(e.key != key) break;
+        out.push_back(e);
+    }
+    return out;
+}
+
+// coup du livre pour p (0 : hors livre, trop profond ou aucun coup légal)
+inline int book_probe(Book &b, Position &p){
+    if(!b.data) return 0;
+    int ply = 2*(p.fullmove-1) + (p.stm==BLACK);
+    if(ply >= b.max_ply) return 0;
+
+    int moves[256], weights[256], n = 0, total = 0;
+    for(const BookEntry &e : book_entries(b, poly_key(p))){
+        int m = book_decode_move(p, e.move);
+        if(!m || n == 256) continue;
+        moves[n] = m; weights[n] = e.weight; n++;
+        total += e.weight;
+    }
+    if(n == 0) return 0;
+
+    if(b.best || total == 0){
+        int bi = 0;
+        for(int i=1;i<n;i++) if(weights[i] > weights[bi]) bi = i;
+        return moves[bi];
+    }
+    int r = (int)(b.rng() % (U64)total);
+    for(int i=0;i<n;i++){
+        if(r < weights[i]) return moves[i];
+        r -= weights[i];
+    }
+    return moves[n-1];
+}
+
+inline int book_probe(Position &p){ return book_probe(book, p); }
+
+// false : le livre ne connaît pas la position initiale avec les clés courantes ;
+// typiquement un livre Polyglot lu sans la table officielle (BookKeys / --keys)
+inline bool book_has_startpos(const Book &b){
+    Position p;
+    set_startpos(p);
+    return !book_entries(b, poly_key(p)).empty();
+}
+
+} // namespace cechess
@@ -0,0 +1,77 @@
+#ifndef CECHESS_H
+#define CECHESS_H
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#define CECHESS_C_API __declspec(dllexport)
+#else
+#define CECHESS_C_API __attribute__((visibility("default")))
+#endif
+
+/* =========================
+ * Bibliothèque : API C
+ * =========================
+ * Mêmes garanties que cechess.hpp : instances isolées, appels possibles
+ * depuis plusieurs threads, callbacks appelés par le thread de recherche
+ * (ils peuvent appeler cechess_stop, pas cechess_go ni cechess_wait).
+ * Codes de retour : 0 = succès, -1 = échec (invalide ou recherche en cours). */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct cechess_engine cechess_engine;
+
+/* 0 = pas de limite ; sans aucune limite la recherche dure jusqu'à cechess_stop */
+typedef struct {
+    int depth;
+    uint64_t nodes;
+    int movetime_ms;
+    int wtime_ms, btime_ms;
+    int winc_ms, binc_ms;
+    int movestogo;
+    int multipv;       /* 0 ou 1 = une ligne */
+} cechess_limits;
+
+typedef struct {
+    int depth, seldepth;
+    int multipv;
+    int score_cp;      /* point de vue du camp au trait */
+    int mate;          /* 0, sinon mat en N coups (N<0 : on est maté) */
+    uint64_t nodes;
+    int time_ms;
+    const char *pv;    /* coups UCI séparés par des espaces, valide pendant l'appel */
+} cechess_info;
+
+typedef void (*cechess_info_cb)(const cechess_info *info, void *user);
+/* ponder = "" si aucun */
+typedef void (*cechess_bestmove_cb)(const char *best, const char *ponder, void *user);
+
+CECHESS_C_API cechess_engine *cechess_new(void);
+CECHESS_C_API void cechess_free(cechess_engine *e);
+
+CECHESS_C_API int cechess_set_hash(cechess_engine *e, size_t mb);
+CECHESS_C_API int cechess_set_threads(cechess_engine *e, int n);
+CECHESS_C_API int cechess_new_game(cechess_engine *e);
+/* fen NULL ou "startpos" = position initiale ; moves : coups UCI séparés par des espaces, ou NULL */
+CECHESS_C_API int cechess_set_position(cechess_engine *e, const char *fen, const char *moves);
+/* pris en compte à la prochaine recherche ; NULL = pas de callback */
+CECHESS_C_API void cechess_set_callbacks(cechess_engine *e, cechess_info_cb info,
+                                         cechess_bestmove_cb bestmove, void *user);
+
+CECHESS_C_API int cechess_go(cechess_engine *e, const cechess_limits *limits);
+CECHESS_C_API void cechess_stop(cechess_engine *e);
+CECHESS_C_API void cechess_wait(cechess_engine *e);
+CECHESS_C_API int cechess_searching(const cechess_engine *e);
+/* synchrone ; écrit le coup UCI dans best (6 octets suffisent), -1 si déjà en recherche */
+CECHESS_C_API int cechess_search(cechess_engine *e, const cechess_limits *limits, char *best, size_t len);
+
+/* réseau NNUE du processus, refusé tant qu'un moteur existe ; NULL ou "" = éval classique */
+CECHESS_C_API int cechess_load_network(const char *path);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CECHESS_H */
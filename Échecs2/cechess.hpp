@@ -0,0 +1,86 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#if defined(_WIN32)
+#define CECHESS_API __declspec(dllexport)
+#else
+#define CECHESS_API __attribute__((visibility("default")))
+#endif
+
+// =========================
+// Bibliothèque : API C++
+// =========================
+// Interface publique de libcechess (cechess_lib.cpp). N'inclut pas
+// engine2.hpp : le moteur n'existe qu'en un exemplaire dans la bibliothèque,
+// chaque Engine a sa TT, ses threads et sa position, sans état partagé.
+// Une instance est utilisable depuis plusieurs threads ; les callbacks sont
+// appelés par le thread de recherche et peuvent appeler stop(), pas go() ni wait().
+
+namespace cechess::api {
+
+// 0 = pas de limite ; sans aucune limite la recherche dure jusqu'à stop()
+struct Limits {
+    int depth = 0;
+    std::uint64_t nodes = 0;
+    int movetime_ms = 0;
+    int wtime_ms = 0, btime_ms = 0;  // pendules : le camp au trait est pris
+    int winc_ms = 0, binc_ms = 0;
+    int movestogo = 0;
+    int multipv = 1;
+};
+
+// une ligne par itération terminée (et par ligne MultiPV)
+struct Info {
+    int depth = 0, seldepth = 0;
+    int multipv = 1;
+    int score_cp = 0;                // point de vue du camp au trait
+    int mate = 0;                    // 0, sinon mat en N coups (N<0 : on est maté)
+    std::uint64_t nodes = 0;
+    int time_ms = 0;
+    std::vector<std::string> pv;     // coups UCI
+};
+
+using InfoCallback = std::function<void(const Info &)>;
+using BestMoveCallback = std::function<void(const std::string &best, const std::string &ponder)>;
+
+class CECHESS_API Engine {
+public:
+    Engine();
+    ~Engine();                       // arrête et attend la recherche en cours
+    Engine(const Engine &) = delete;
+    Engine &operator=(const Engine &) = delete;
+
+    // Réglages et position : false pendant une recherche (ou si invalide)
+    bool set_hash(std::size_t mb);
+    bool set_threads(int n);
+    bool new_game();                 // vide la TT
+    // fen "startpos" ou FEN complète, puis coups UCI depuis cette position
+    bool set_position(const std::string &fen, const std::vector<std::string> &moves = {});
+
+    void on_info(InfoCallback cb);
+    void on_bestmove(BestMoveCallback cb);
+
+    // Recherche asynchrone ; false si une recherche est déjà en cours
+    bool go(const Limits &limits);
+    void stop();                     // ne bloque pas
+    void wait();                     // attend la fin de la recherche en cours
+    bool searching() const;
+
+    // Recherche synchrone : meilleur coup UCI ("0000" si aucun coup légal)
+    std::string search(const Limits &limits);
+
+    struct Impl;
+private:
+    std::unique_ptr<Impl> impl;
+};
+
+// Réseau NNUE commun à tout le processus (lecture seule pendant les recherches) :
+// refusé tant qu'une instance Engine existe. Chaîne vide = éval classique.
+CECHESS_API bool load_network(const std::string &path);
+
+} // namespace cechess::api
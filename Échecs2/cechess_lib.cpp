@@ -0,0 +1,311 @@
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "engine2.hpp"
+#include "cechess.hpp"
+#include "cechess.h"
+
+// =========================
+// Bibliothèque embarquable (libcechess)
+// =========================
+// Seule unité de traduction qui inclut engine2.hpp : les globales statiques
+// du moteur n'existent qu'une fois, et chaque api::Engine possède son propre
+// cechess::Engine (TT, threads, historique), sans passer par main_engine ni TT.
+// Les recherches tournent sur un thread dédié ; le mutex ne protège que
+// l'état de l'instance (position, callbacks, thread), jamais la recherche.
+
+namespace cechess::api {
+
+// Le réseau NNUE est global au processus : on ne le change que sans moteur vivant
+static std::mutex lib_net_mtx;
+static int lib_live_engines = 0;
+
+struct Engine::Impl {
+    cechess::Engine eng;
+    Position pos;
+    std::vector<U64> keys;         // historique depuis la FEN, dernière entrée = pos
+    InfoCallback info_cb;
+    BestMoveCallback best_cb;
+    InfoCallback run_info;         // copies figées au lancement de la recherche
+    BestMoveCallback run_best;
+    std::thread worker;
+    mutable std::mutex mtx;
+    std::condition_variable done;
+    bool busy = false;
+    std::string result;             // meilleur coup de la dernière recherche
+};
+
+static void lib_report(const SearchReport &r, void *ctx) {
+    Engine::Impl &im = *static_cast<Engine::Impl *>(ctx);
+    if (!im.run_info) return;
+    Info info;
+    info.depth = r.depth;
+    info.seldepth = r.seldepth;
+    info.multipv = r.multipv;
+    info.score_cp = r.score;
+    info.mate = r.mate;
+    info.nodes = r.nodes;
+    info.time_ms = r.time_ms;
+    for (int m : r.pv) info.pv.push_back(move_to_str(m));
+    im.run_info(info);
+}
+
+static SearchLimits lib_limits(const Limits &l, const Position &p) {
+    SearchLimits lim;
+    if (l.depth > 0) lim.depth = l.depth;
+    lim.nodes = l.nodes;
+    lim.multipv = std::max(l.multipv, 1);
+    if (l.movetime_ms > 0) {
+        lim.time_ms = l.movetime_ms;
+    } else {
+        lim.clock_ms  = p.stm == WHITE ? l.wtime_ms : l.btime_ms;
+        lim.inc_ms    = p.stm == WHITE ? l.winc_ms : l.binc_ms;
+        lim.movestogo = l.movestogo;
+    }
+    return lim;
+}
+
+static void lib_search_worker(Engine::Impl &im, Position p, std::vector<U64> keys, SearchLimits lim) {
+    set_history(im.eng, keys.data(), (int)keys.size());
+    int best = 0;
+    search_best_move(im.eng, p, lim, best);
+    if (!best) {
+        int moves[256];
+        if (generate_legal_moves(p, moves) > 0) best = moves[0];
+    }
+
+    std::string bm = best ? move_to_str(best) : "0000", ponder;
+    if (best) {
+        std::vector<int> pv = im.eng.last.pv;
+        if (pv.size() < 2 || pv[0] != best) pv = extract_pv(*im.eng.tt, p, best, 2);
+        if (pv.size() >= 2) ponder = move_to_str(pv[1]);
+    }
+    if (im.run_best) im.run_best(bm, ponder);
+
+    {
+        std::lock_guard<std::mutex> lk(im.mtx);
+        im.result = bm;
+        im.busy = false;
+    }
+    im.done.notify_all();
+}
+
+Engine::Engine() : impl(std::make_unique<Impl>()) {
+    {
+        std::lock_guard<std::mutex> lk(lib_net_mtx);
+        ++lib_live_engines;
+    }
+    cechess::set_threads(impl->eng, 1);
+    impl->eng.reporter = lib_report;
+    impl->eng.reporter_ctx = impl.get();
+    set_startpos(impl->pos);
+    impl->keys.assign(1, impl->pos.key);
+}
+
+Engine::~Engine() {
+    stop();
+    wait();
+    if (impl->worker.joinable()) impl->worker.join();
+    std::lock_guard<std::mutex> lk(lib_net_mtx);
+    --lib_live_engines;
+}
+
+bool Engine::set_hash(std::size_t mb) {
+    std::lock_guard<std::mutex> lk(impl->mtx);
+    if (impl->busy || mb == 0) return false;
+    try {
+        tt_resize(impl->eng.own_tt, mb);
+    } catch (const std::bad_alloc &) {
+        return false;
+    }
+    return true;
+}
+
+bool Engine::set_threads(int n) {
+    std::lock_guard<std::mutex> lk(impl->mtx);
+    if (impl->busy || n < 1) return false;
+    cechess::set_threads(impl->eng, n);
+    return true;
+}
+
+bool Engine::new_game() {
+    std::lock_guard<std::mutex> lk(impl->mtx);
+    if (impl->busy) return false;
+    if (impl->eng.own_tt.buckets) tt_clear(impl->eng.own_tt);
+    return true;
+}
+
+bool Engine::set_position(const std::string &fen, const std::vector<std::string> &moves) {
+    Position p;
+    if (fen.empty() || fen == "startpos") set_startpos(p);
+    else if (!set_fen(p, fen)) return false;
+    std::vector<U64> keys{p.key};
+    for (const std::string &s : moves) {
+        int m = parse_move(p, s);
+        if (!m) return false;
+        Undo u;
+        make_move(p, m, u);
+        keys.push_back(p.key);
+    }
+
+    std::lock_guard<std::mutex> lk(impl->mtx);
+    if (impl->busy) return false;
+    impl->pos = p;
+    impl->keys = std::move(keys);
+    return true;
+}
+
+void Engine::on_info(InfoCallback cb) {
+    std::lock_guard<std::mutex> lk(impl->mtx);
+    impl->info_cb = std::move(cb);
+}
+
+void Engine::on_bestmove(BestMoveCallback cb) {
+    std::lock_guard<std::mutex> lk(impl->mtx);
+    impl->best_cb = std::move(cb);
+}
+
+bool Engine::go(const Limits &limits) {
+    std::lock_guard<std::mutex> lk(impl->mtx);
+    if (impl->busy) return false;
+    // busy == false : l'ancien worker a fini son travail, il ne reprendra plus le mutex
+    if (impl->worker.joinable()) impl->worker.join();
+    impl->busy = true;
+    impl->result.clear();
+    impl->run_info = impl->info_cb;
+    impl->run_best = impl->best_cb;
+    impl->eng.stop = false;
+    impl->worker = std::thread(lib_search_worker, std::ref(*impl), impl->pos, impl->keys,
+                               lib_limits(limits, impl->pos));
+    return true;
+}
+
+void Engine::stop() { impl->eng.stop = true; }
+
+void Engine::wait() {
+    std::unique_lock<std::mutex> lk(impl->mtx);
+    impl->done.wait(lk, [&]{ return !impl->busy; });
+}
+
+bool Engine::searching() const {
+    std::lock_guard<std::mutex> lk(impl->mtx);
+    return impl->busy;
+}
+
+std::string Engine::search(const Limits &limits) {
+    if (!go(limits)) return "0000";
+    std::unique_lock<std::mutex> lk(impl->mtx);
+    impl->done.wait(lk, [&]{ return !impl->busy; });
+    return impl->result;
+}
+
+bool load_network(const std::string &path) {
+    std::lock_guard<std::mutex> lk(lib_net_mtx);
+    if (lib_live_engines > 0) return false;
+    if (path.empty()) return set_eval_backend(false);
+    return nnue_load(path) && set_eval_backend(true);
+}
+
+} // namespace cechess::api
+
+// =========================
+// API C : enveloppe de api::Engine
+// =========================
+
+struct cechess_engine {
+    cechess::api::Engine cpp;
+};
+
+static cechess::api::Limits c_limits(const cechess_limits *l) {
+    cechess::api::Limits r;
+    if (!l) return r;
+    r.depth = l->depth;
+    r.nodes = l->nodes;
+    r.movetime_ms = l->movetime_ms;
+    r.wtime_ms = l->wtime_ms;
+    r.btime_ms = l->btime_ms;
+    r.winc_ms = l->winc_ms;
+    r.binc_ms = l->binc_ms;
+    r.movestogo = l->movestogo;
+    r.multipv = l->multipv;
+    return r;
+}
+
+extern "C" {
+
+cechess_engine *cechess_new(void) {
+    try {
+        return new cechess_engine();
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void cechess_free(cechess_engine *e) { delete e; }
+
+int cechess_set_hash(cechess_engine *e, size_t mb) { return e->cpp.set_hash(mb) ? 0 : -1; }
+
+int cechess_set_threads(cechess_engine *e, int n) { return e->cpp.set_threads(n) ? 0 : -1; }
+
+int cechess_new_game(cechess_engine *e) { return e->cpp.new_game() ? 0 : -1; }
+
+int cechess_set_position(cechess_engine *e, const char *fen, const char *moves) {
+    std::vector<std::string> mv;
+    if (moves) {
+        std::istringstream is(moves);
+        for (std::string s; is >> s; ) mv.push_back(s);
+    }
+    return e->cpp.set_position(fen ? fen : "startpos", mv) ? 0 : -1;
+}
+
+void cechess_set_callbacks(cechess_engine *e, cechess_info_cb info,
+                           cechess_bestmove_cb bestmove, void *user) {
+    // capturés par valeur : pris en compte à la prochaine recherche
+    if (info) {
+        e->cpp.on_info([info, user](const cechess::api::Info &i) {
+            std::string pv;
+            for (const std::string &m : i.pv) pv += (pv.empty() ? "" : " ") + m;
+            cechess_info ci{i.depth, i.seldepth, i.multipv, i.score_cp, i.mate, i.nodes, i.time_ms, pv.c_str()};
+            info(&ci, user);
+        });
+    } else {
+        e->cpp.on_info(nullptr);
+    }
+    if (bestmove) {
+        e->cpp.on_bestmove([bestmove, user](const std::string &best, const std::string &ponder) {
+            bestmove(best.c_str(), ponder.c_str(), user);
+        });
+    } else {
+        e->cpp.on_bestmove(nullptr);
+    }
+}
+
+int cechess_go(cechess_engine *e, const cechess_limits *limits) {
+    return e->cpp.go(c_limits(limits)) ? 0 : -1;
+}
+
+void cechess_stop(cechess_engine *e) { e->cpp.stop(); }
+
+void cechess_wait(cechess_engine *e) { e->cpp.wait(); }
+
+int cechess_searching(const cechess_engine *e) { return e->cpp.searching() ? 1 : 0; }
+
+int cechess_search(cechess_engine *e, const cechess_limits *limits, char *best, size_t len) {
+    if (e->cpp.searching()) return -1;
+    std::string m = e->cpp.search(c_limits(limits));
+    if (best && len) {
+        std::strncpy(best, m.c_str(), len - 1);
+        best[len - 1] = 0;
+    }
+    return 0;
+}
+
+int cechess_load_network(const char *path) {
+    return cechess::api::load_network(path ? path : "") ? 0 : -1;
+}
+
+} // extern "C"
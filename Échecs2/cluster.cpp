@@ -0,0 +1,642 @@
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <csignal>
+#include <poll.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include "engine2.hpp"
+#include "packed.hpp"
+
+using namespace cechess;
+
+// =========================
+// Analyse distribuée (Lazy SMP sur plusieurs machines)
+// =========================
+// Un coordinateur (--listen) attend --workers processus (--connect), leur
+// envoie la position, puis tous cherchent la même racine avec leur propre
+// TT et leurs threads. Chaque nœud publie ses entrées de TT de profondeur
+// >= --share-depth ; elles partent par lots toutes les --sync ms vers le
+// coordinateur, qui les applique et les relaie aux autres nœuds (étoile TCP).
+// Le rang du nœud décale la profondeur de ses helpers, comme les helpers
+// impairs d'un même processus. Le premier nœud à terminer --depth arrête
+// tout le monde ; le résultat est celui de la profondeur la plus grande
+// terminée, quel que soit le nœud. Les scores de mat stockés dans la TT
+// dépendent du ply de la racine : tous les nœuds rejouent le même historique.
+// POSIX uniquement (sockets).
+
+struct ClusterOptions {
+    int listenPort = 0;        // coordinateur
+    std::string connect;       // worker : hôte:port
+    int workers = 1;           // workers distants attendus par le coordinateur
+    std::string fen = "startpos";
+    std::string moves;         // coups UCI joués depuis fen
+    int depth = 64;
+    int movetimeMs = 0;        // 0 = jusqu'à --depth
+    int threads = 1;           // par nœud
+    int hashMb = 64;           // par nœud
+    int shareDepth = 8;
+    int syncMs = 10;
+    int retrySec = 30;         // worker : attente du coordinateur
+    std::string nnue;
+};
+
+static void usage() {
+    std::cout << "Usage: cluster --listen PORT [--workers N] [--fen FEN | --fen startpos] [--moves \"e2e4 ...\"]\n"
+                 "               [--depth N] [--movetime ms] [options]\n"
+                 "       cluster --connect HOST:PORT [--retry s] [options]\n"
+                 "  options : [--threads N] [--hash MB] [--share-depth N] [--sync ms] [--nnue file]\n"
+                 "  --threads / --hash : par nœud ; la position et les limites viennent du coordinateur\n";
+}
+
+// =========================
+// Trames
+// =========================
+// [type: 1 octet][longueur: 4 octets LE][contenu]
+// JOB   coord -> worker : "rang profondeur share_depth\nfen\ncoups"
+// TT    dans les deux sens : entrées de 14 octets (clé 8, score 2, coup 2, profondeur 1, borne 1)
+// INFO  worker -> coord  : "profondeur seldepth score mat noeuds ms coup..." à chaque itération terminée
+// STOP  coord -> worker  : fin de la recherche
+// DONE  worker -> coord  : "profondeur noeuds" une fois la recherche rendue
+// QUIT  coord -> worker  : fin de session
+
+enum FrameType : unsigned char { FRAME_JOB = 1, FRAME_TT, FRAME_INFO, FRAME_STOP, FRAME_DONE, FRAME_QUIT };
+
+constexpr int FRAME_HEADER = 5;
+constexpr int TT_RECORD = 14;
+constexpr size_t TT_BATCH = 4096;                  // entrées par trame
+constexpr size_t SHARE_QUEUE_MAX = 1 << 18;        // au-delà, les entrées publiées sont perdues
+constexpr size_t PEER_BACKLOG_MAX = 16 << 20;      // octets en attente par pair avant de perdre du TT
+
+struct Peer {
+    int fd = -1;
+    int rank = 0;
+    std::string in;                  // octets reçus, pas encore découpés
+    std::string out;                 // en attente d'envoi
+    bool done = false;               // DONE reçu
+    U64 nodes = 0;                   // dernier compte reçu
+};
+
+static void frame_append(std::string &out, FrameType type, const std::string &payload) {
+    unsigned char h[FRAME_HEADER];
+    h[0] = type;
+    put_le(h + 1, payload.size(), 4);
+    out.append((const char *)h, FRAME_HEADER);
+    out += payload;
+}
+
+// découpe une trame complète en tête de 'in' ; false s'il en manque une partie
+static bool frame_pop(std::string &in, FrameType &type, std::string &payload) {
+    if (in.size() < (size_t)FRAME_HEADER) return false;
+    size_t len = get_le((const unsigned char *)in.data() + 1, 4);
+    if (in.size() < FRAME_HEADER + len) return false;
+    type = FrameType((unsigned char)in[0]);
+    payload.assign(in, FRAME_HEADER, len);
+    in.erase(0, FRAME_HEADER + len);
+    return true;
+}
+
+static std::string encode_tt(const TTShare *s, size_t n) {
+    std::string r(n * TT_RECORD, '\0');
+    unsigned char *q = (unsigned char *)r.data();
+    for (size_t i = 0; i < n; ++i, q += TT_RECORD) {
+        put_le(q, s[i].key, 8);
+        put_le(q + 8, (uint16_t)s[i].score, 2);
+        put_le(q + 10, s[i].move, 2);
+        q[12] = (unsigned char)s[i].depth;
+        q[13] = (unsigned char)s[i].flag;
+    }
+    return r;
+}
+
+// entrées reçues : écrites dans la TT locale comme par un helper ; renvoie le nombre appliqué
+static size_t apply_tt(TranspositionTable &tt, const std::string &payload) {
+    const unsigned char *q = (const unsigned char *)payload.data();
+    size_t n = payload.size() / TT_RECORD, applied = 0;
+    for (size_t i = 0; i < n; ++i, q += TT_RECORD) {
+        int depth = (int8_t)q[12], flag = q[13];
+        if (depth < 1 || depth > MAX_PLY || flag > 2) continue;
+        store_tt(tt, get_le(q, 8), depth, (int16_t)get_le(q + 8, 2), flag, (int)get_le(q + 10, 2));
+        ++applied;
+    }
+    return applied;
+}
+
+// envoie ce qui peut partir sans bloquer ; false si la connexion est perdue
+static bool peer_flush(Peer &p) {
+    while (!p.out.empty()) {
+        ssize_t n = send(p.fd, p.out.data(), p.out.size(), MSG_NOSIGNAL);
+        if (n < 0) return errno == EAGAIN || errno == EWOULDBLOCK;
+        p.out.erase(0, (size_t)n);
+    }
+    return true;
+}
+
+// lit tout ce qui est disponible ; false si la connexion est fermée
+static bool peer_read(Peer &p) {
+    char buf[1 << 16];
+    while (true) {
+        ssize_t n = recv(p.fd, buf, sizeof buf, 0);
+        if (n > 0) { p.in.append(buf, (size_t)n); continue; }
+        if (n == 0) return false;
+        return errno == EAGAIN || errno == EWOULDBLOCK;
+    }
+}
+
+static void set_socket_options(int fd) {
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof one);
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+}
+
+// =========================
+// Nœud de recherche
+// =========================
+// Partagé entre le thread de recherche (publication, rapports) et le thread
+// réseau (envoi, réception) ; les files 'shared' et 'reports' sont protégées par 'mtx'.
+
+struct ClusterNode {
+    TranspositionTable tt;           // vieillie ici avant la recherche : le thread réseau y écrit aussi
+    Engine e;
+    std::mutex mtx;
+    std::vector<TTShare> shared;     // entrées publiées, pas encore envoyées
+    std::string reports;             // trames INFO du worker, pas encore envoyées
+    std::atomic<bool> active{false}; // une recherche est en cours : le TT reçu est utile
+    std::atomic<U64> sent{0}, received{0}, dropped{0};
+};
+
+static void node_share(const TTShare &s, void *ctx) {
+    ClusterNode &n = *static_cast<ClusterNode *>(ctx);
+    std::lock_guard<std::mutex> lk(n.mtx);
+    if (n.shared.size() >= SHARE_QUEUE_MAX) { ++n.dropped; return; }
+    n.shared.push_back(s);
+}
+
+// vide la file de publication en trames TT
+static std::string node_take_tt(ClusterNode &n) {
+    std::vector<TTShare> batch;
+    {
+        std::lock_guard<std::mutex> lk(n.mtx);
+        batch.swap(n.shared);
+    }
+    std::string out;
+    for (size_t i = 0; i < batch.size(); i += TT_BATCH)
+        frame_append(out, FRAME_TT, encode_tt(batch.data() + i, std::min(TT_BATCH, batch.size() - i)));
+    n.sent += batch.size();
+    return out;
+}
+
+static void node_setup(ClusterNode &n, const ClusterOptions &opt) {
+    tt_resize(n.tt, std::max(opt.hashMb, 1));
+    n.e.tt = &n.tt;
+    n.e.ages_tt = false;        // tt_new_search avant que le fil réseau ne lise la table
+    set_threads(n.e, std::max(opt.threads, 1));
+    n.e.share = node_share;
+    n.e.share_ctx = &n;
+}
+
+// position + historique depuis fen et coups ; false si l'un est invalide
+static bool build_position(const std::string &fen, const std::string &moves, Position &p, std::vector<U64> &keys) {
+    if (fen == "startpos") set_startpos(p);
+    else if (!set_fen(p, fen)) return false;
+    keys.assign(1, p.key);
+    std::istringstream is(moves);
+    for (std::string s; is >> s; ) {
+        int m = parse_move(p, s);
+        if (!m) return false;
+        Undo u;
+        make_move(p, m, u);
+        keys.push_back(p.key);
+    }
+    return true;
+}
+
+static std::string pv_string(const std::vector<int> &pv) {
+    std::string s;
+    for (int m : pv) s += (s.empty() ? "" : " ") + move_to_str(m);
+    return s;
+}
+
+// =========================
+// Coordinateur
+// =========================
+
+struct Furthest {
+    std::mutex mtx;
+    int depth = 0, seldepth = 0, score = 0, mate = 0, rank = -1;
+    std::string pv;                  // coups UCI, le premier est le meilleur coup
+    std::chrono::steady_clock::time_point start;
+};
+
+// nouvelle itération terminée sur le nœud 'rank' ; true si elle est la plus profonde
+static bool furthest_update(Furthest &f, int rank, int depth, int seldepth, int score, int mate, const std::string &pv, U64 nodes) {
+    std::lock_guard<std::mutex> lk(f.mtx);
+    if (depth <= f.depth || pv.empty()) return false;
+    f.depth = depth; f.seldepth = seldepth; f.score = score; f.mate = mate; f.rank = rank; f.pv = pv;
+    int ms = (int)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - f.start).count();
+    std::ostringstream os;
+    os << "info node " << rank << " depth " << depth << " seldepth " << seldepth;
+    if (mate) os << " score mate " << mate;
+    else      os << " score cp " << score;
+    os << " nodes " << nodes << " time " << ms << " pv " << pv;
+    std::cout << os.str() << std::endl;
+    return true;
+}
+
+static void coord_report(const SearchReport &r, void *ctx) {
+    furthest_update(*static_cast<Furthest *>(ctx), 0, r.depth, r.seldepth, r.score, r.mate, pv_string(r.pv), r.nodes);
+}
+
+static int listen_on(int port) {
+    int fd = socket(AF_INET6, SOCK_STREAM, 0);
+    bool v6 = fd >= 0;
+    if (!v6) fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    int one = 1, zero = 0;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof one);
+    int r;
+    if (v6) {
+        setsockopt(fd, IPPROTO_IPV6, IPV6_V6ONLY, &zero, sizeof zero);
+        sockaddr_in6 a{};
+        a.sin6_family = AF_INET6;
+        a.sin6_addr = in6addr_any;
+        a.sin6_port = htons((uint16_t)port);
+        r = bind(fd, (sockaddr *)&a, sizeof a);
+    } else {
+        sockaddr_in a{};
+        a.sin_family = AF_INET;
+        a.sin_addr.s_addr = htonl(INADDR_ANY);
+        a.sin_port = htons((uint16_t)port);
+        r = bind(fd, (sockaddr *)&a, sizeof a);
+    }
+    if (r < 0 || listen(fd, 64) < 0) { close(fd); return -1; }
+    return fd;
+}
+
+static int run_coordinator(const ClusterOptions &opt) {
+    Position root;
+    std::vector<U64> keys;
+    if (!build_position(opt.fen, opt.moves, root, keys)) {
+        std::cerr << "Invalid position or moves\n";
+        return 1;
+    }
+    int lfd = listen_on(opt.listenPort);
+    if (lfd < 0) {
+        std::cerr << "Cannot listen on port " << opt.listenPort << ": " << std::strerror(errno) << "\n";
+        return 1;
+    }
+
+    std::vector<Peer> peers(opt.workers);
+    for (int i = 0; i < opt.workers; ++i) {
+        sockaddr_storage a{};
+        socklen_t len = sizeof a;
+        int fd = accept(lfd, (sockaddr *)&a, &len);
+        if (fd < 0) { --i; continue; }
+        char host[NI_MAXHOST] = "?";
+        getnameinfo((sockaddr *)&a, len, host, sizeof host, nullptr, 0, NI_NUMERICHOST);
+        set_socket_options(fd);
+        peers[i].fd = fd;
+        peers[i].rank = i + 1;
+        std::cerr << "node " << i + 1 << " connected from " << host << "\n";
+    }
+    close(lfd);
+
+    ClusterNode node;
+    node_setup(node, opt);
+    node.e.share_depth = opt.shareDepth;
+    Furthest furthest;
+    node.e.reporter = coord_report;
+    node.e.reporter_ctx = &furthest;
+
+    int maxDepth = std::clamp(opt.depth, 1, MAX_PLY);
+    for (Peer &p : peers) {
+        std::ostringstream job;
+        job << p.rank << " " << maxDepth << " " << opt.shareDepth << "\n" << opt.fen << "\n" << opt.moves;
+        frame_append(p.out, FRAME_JOB, job.str());
+    }
+
+    // thread réseau : lots TT, relais, rapports des workers, arrêt commun
+    std::atomic<bool> searchDone{false};
+    std::atomic<int> alive{(int)peers.size()};
+    furthest.start = std::chrono::steady_clock::now();
+    tt_new_search(node.tt);
+    node.active = true;
+    std::thread net([&] {
+        bool stopSent = false;
+        auto lastSync = std::chrono::steady_clock::now();
+        while (true) {
+            if (searchDone && !stopSent) {
+                for (Peer &p : peers) if (p.fd >= 0) frame_append(p.out, FRAME_STOP, "");
+                stopSent = true;
+            }
+            auto now = std::chrono::steady_clock::now();
+            if (now - lastSync >= std::chrono::milliseconds(opt.syncMs)) {
+                lastSync = now;
+                std::string own = node_take_tt(node);
+                for (Peer &p : peers) {
+                    if (p.fd < 0 || own.empty()) continue;
+                    if (p.out.size() < PEER_BACKLOG_MAX) p.out += own;
+                    else node.dropped += own.size() / TT_RECORD;
+                }
+            }
+            bool allDone = stopSent;
+            for (Peer &p : peers) if (p.fd >= 0 && !p.done) allDone = false;
+            if (allDone) break;
+
+            std::vector<pollfd> pfd;
+            for (Peer &p : peers)
+                pfd.push_back({p.fd, (short)(POLLIN | (p.out.empty() ? 0 : POLLOUT)), 0});
+            poll(pfd.data(), pfd.size(), opt.syncMs);
+
+            for (size_t i = 0; i < peers.size(); ++i) {
+                Peer &p = peers[i];
+                if (p.fd < 0) continue;
+                bool ok = peer_flush(p) && (!(pfd[i].revents & (POLLIN | POLLHUP | POLLERR)) || peer_read(p));
+                FrameType type;
+                std::string payload;
+                while (ok && frame_pop(p.in, type, payload)) {
+                    if (type == FRAME_TT) {
+                        node.received += apply_tt(node.tt, payload);
+                        std::string fwd;
+                        frame_append(fwd, FRAME_TT, payload);
+                        for (Peer &q : peers) {
+                            if (&q == &p || q.fd < 0) continue;
+                            if (q.out.size() < PEER_BACKLOG_MAX) q.out += fwd;
+                            else node.dropped += payload.size() / TT_RECORD;
+                        }
+                    } else if (type == FRAME_INFO) {
+                        std::istringstream is(payload);
+                        int d, sd, sc, mt;
+                        U64 nodes;
+                        int ms;
+                        std::string pv, m;
+                        is >> d >> sd >> sc >> mt >> nodes >> ms;
+                        while (is >> m) pv += (pv.empty() ? "" : " ") + m;
+                        p.nodes = nodes;
+                        furthest_update(furthest, p.rank, d, sd, sc, mt, pv, nodes);
+                        if (d >= maxDepth) node.e.stop = true;
+                    } else if (type == FRAME_DONE) {
+                        std::istringstream is(payload);
+                        int d;
+                        is >> d >> p.nodes;
+                        p.done = true;
+                    }
+                }
+                if (!ok) {
+                    std::cerr << "node " << p.rank << " disconnected\n";
+                    close(p.fd);
+                    p.fd = -1;
+                    --alive;
+                }
+            }
+        }
+        // fin de session ; les sockets sont rendues bloquantes pour vider les derniers octets
+        for (Peer &p : peers) {
+            if (p.fd < 0) continue;
+            frame_append(p.out, FRAME_QUIT, "");
+            fcntl(p.fd, F_SETFL, fcntl(p.fd, F_GETFL) & ~O_NONBLOCK);
+            peer_flush(p);
+            close(p.fd);
+        }
+    });
+
+    SearchLimits lim;
+    lim.depth = maxDepth;
+    lim.time_ms = opt.movetimeMs;
+    set_history(node.e, keys.data(), (int)keys.size());
+    node.e.stop = false;
+    int best = 0;
+    search_best_move(node.e, root, lim, best);
+    node.active = false;
+    U64 ownNodes = get_nodes(node.e);
+    searchDone = true;
+    net.join();
+
+    // coup de la profondeur terminée la plus grande, tous nœuds confondus
+    std::string bm, ponder;
+    {
+        std::istringstream is(furthest.pv);
+        is >> bm >> ponder;
+    }
+    if (bm.empty()) {
+        int moves[256];
+        if (!best && generate_legal_moves(root, moves) > 0) best = moves[0];
+        bm = best ? move_to_str(best) : "0000";
+    }
+    U64 total = ownNodes;
+    for (Peer &p : peers) total += p.nodes;
+    double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - furthest.start).count();
+    std::cout << "bestmove " << bm << (ponder.empty() ? "" : " ponder " + ponder) << std::endl;
+    std::cerr << "Depth " << furthest.depth << " (node " << furthest.rank << ")  nodes " << total
+              << "  time " << std::fixed << std::setprecision(2) << sec << "s  nps "
+              << (U64)(total / std::max(sec, 1e-3)) << "\n"
+              << "TT sent " << node.sent << "  received " << node.received << "  dropped " << node.dropped
+              << "  nodes alive " << alive << "/" << peers.size() << "\n";
+    return 0;
+}
+
+// =========================
+// Worker
+// =========================
+
+static int connect_to(const std::string &hostPort, int retrySec) {
+    size_t colon = hostPort.rfind(':');
+    if (colon == std::string::npos) return -1;
+    std::string host = hostPort.substr(0, colon), port = hostPort.substr(colon + 1);
+    if (host.size() > 2 && host.front() == '[' && host.back() == ']') host = host.substr(1, host.size() - 2);
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(retrySec);
+    while (true) {
+        addrinfo hints{}, *res = nullptr;
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        if (getaddrinfo(host.c_str(), port.c_str(), &hints, &res) == 0) {
+            for (addrinfo *a = res; a; a = a->ai_next) {
+                int fd = socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+                if (fd < 0) continue;
+                if (connect(fd, a->ai_addr, a->ai_addrlen) == 0) { freeaddrinfo(res); return fd; }
+                close(fd);
+            }
+            freeaddrinfo(res);
+        }
+        if (std::chrono::steady_clock::now() >= deadline) return -1;
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+    }
+}
+
+struct WorkerJob {
+    int rank = 0, depth = 64, shareDepth = 8;
+    std::string fen, moves;
+};
+
+static void worker_report(const SearchReport &r, void *ctx) {
+    ClusterNode &n = *static_cast<ClusterNode *>(ctx);
+    std::ostringstream os;
+    os << r.depth << " " << r.seldepth << " " << r.score << " " << r.mate << " " << r.nodes << " " << r.time_ms;
+    for (int m : r.pv) os << " " << move_to_str(m);
+    std::lock_guard<std::mutex> lk(n.mtx);
+    frame_append(n.reports, FRAME_INFO, os.str());
+}
+
+static int run_worker(const ClusterOptions &opt) {
+    int fd = connect_to(opt.connect, opt.retrySec);
+    if (fd < 0) {
+        std::cerr << "Cannot connect to " << opt.connect << "\n";
+        return 1;
+    }
+    set_socket_options(fd);
+
+    ClusterNode node;
+    node_setup(node, opt);
+    node.e.reporter = worker_report;
+    node.e.reporter_ctx = &node;
+
+    Peer coord;
+    coord.fd = fd;
+    std::mutex jobMtx;
+    std::condition_variable jobCv;
+    std::vector<WorkerJob> jobs;
+    bool quit = false;
+    std::string doneFrames;          // trames DONE déposées par le thread de recherche
+
+    std::thread net([&] {
+        auto lastSync = std::chrono::steady_clock::now();
+        bool ok = true;
+        while (ok) {
+            auto now = std::chrono::steady_clock::now();
+            if (now - lastSync >= std::chrono::milliseconds(opt.syncMs)) {
+                lastSync = now;
+                std::string own = node_take_tt(node);
+                if (coord.out.size() < PEER_BACKLOG_MAX) coord.out += own;
+                else node.dropped += own.size() / TT_RECORD;
+            }
+            {
+                // rapports avant DONE : l'ordre des trames reste celui de la recherche
+                std::lock_guard<std::mutex> lk(node.mtx);
+                coord.out += node.reports;
+                node.reports.clear();
+            }
+            {
+                std::lock_guard<std::mutex> lk(jobMtx);
+                coord.out += doneFrames;
+                doneFrames.clear();
+            }
+
+            pollfd pfd{fd, (short)(POLLIN | (coord.out.empty() ? 0 : POLLOUT)), 0};
+            poll(&pfd, 1, opt.syncMs);
+            ok = peer_flush(coord) && (!(pfd.revents & (POLLIN | POLLHUP | POLLERR)) || peer_read(coord));
+
+            FrameType type;
+            std::string payload;
+            while (frame_pop(coord.in, type, payload)) {
+                if (type == FRAME_TT) {
+                    if (node.active) node.received += apply_tt(node.tt, payload);
+                } else if (type == FRAME_JOB) {
+                    WorkerJob j;
+                    std::istringstream is(payload);
+                    std::string line;
+                    std::getline(is, line);
+                    std::istringstream hdr(line);
+                    hdr >> j.rank >> j.depth >> j.shareDepth;
+                    std::getline(is, j.fen);
+                    std::getline(is, j.moves);
+                    // remis à faux ici et non par la recherche : un STOP qui suit n'est pas perdu
+                    node.e.stop = false;
+                    std::lock_guard<std::mutex> lk(jobMtx);
+                    jobs.push_back(j);
+                    jobCv.notify_all();
+                } else if (type == FRAME_STOP) {
+                    node.e.stop = true;
+                } else if (type == FRAME_QUIT) {
+                    ok = false;
+                    break;
+                }
+            }
+        }
+        node.e.stop = true;
+        std::lock_guard<std::mutex> lk(jobMtx);
+        quit = true;
+        jobCv.notify_all();
+    });
+
+    while (true) {
+        WorkerJob j;
+        {
+            std::unique_lock<std::mutex> lk(jobMtx);
+            jobCv.wait(lk, [&] { return quit || !jobs.empty(); });
+            if (jobs.empty()) break;
+            j = jobs.front();
+            jobs.erase(jobs.begin());
+        }
+        Position p;
+        std::vector<U64> keys;
+        int depth = 0;
+        if (build_position(j.fen, j.moves, p, keys)) {
+            node.e.id_offset = j.rank;
+            node.e.share_depth = j.shareDepth;
+            set_history(node.e, keys.data(), (int)keys.size());
+            SearchLimits lim;
+            lim.depth = std::clamp(j.depth, 1, MAX_PLY);
+            tt_new_search(node.tt);
+            node.active = true;
+            int best = 0;
+            search_best_move(node.e, p, lim, best);
+            node.active = false;
+            depth = node.e.last.depth;
+            std::cerr << "node " << j.rank << "  depth " << depth << "  nodes " << get_nodes(node.e) << "\n";
+        } else {
+            std::cerr << "Invalid job position\n";
+        }
+        std::ostringstream os;
+        os << depth << " " << get_nodes(node.e);
+        std::lock_guard<std::mutex> lk(jobMtx);
+        frame_append(doneFrames, FRAME_DONE, os.str());
+    }
+    net.join();
+    close(fd);
+    std::cerr << "TT sent " << node.sent << "  received " << node.received << "  dropped " << node.dropped << "\n";
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    ClusterOptions opt;
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        bool hasArg = i + 1 < argc;
+        if      (a == "--listen"      && hasArg) opt.listenPort = std::atoi(argv[++i]);
+        else if (a == "--connect"     && hasArg) opt.connect = argv[++i];
+        else if (a == "--workers"     && hasArg) opt.workers = std::atoi(argv[++i]);
+        else if (a == "--fen"         && hasArg) opt.fen = argv[++i];
+        else if (a == "--moves"       && hasArg) opt.moves = argv[++i];
+        else if (a == "--depth"       && hasArg) opt.depth = std::atoi(argv[++i]);
+        else if (a == "--movetime"    && hasArg) opt.movetimeMs = std::atoi(argv[++i]);
+        else if (a == "--threads"     && hasArg) opt.threads = std::atoi(argv[++i]);
+        else if (a == "--hash"        && hasArg) opt.hashMb = std::atoi(argv[++i]);
+        else if (a == "--share-depth" && hasArg) opt.shareDepth = std::atoi(argv[++i]);
+        else if (a == "--sync"        && hasArg) opt.syncMs = std::max(1, std::atoi(argv[++i]));
+        else if (a == "--retry"       && hasArg) opt.retrySec = std::atoi(argv[++i]);
+        else if (a == "--nnue"        && hasArg) opt.nnue = argv[++i];
+        else if (a == "-h" || a == "--help") { usage(); return 0; }
+        else { usage(); return 1; }
+    }
+    if ((opt.listenPort > 0) == !opt.connect.empty() || opt.workers < 0) { usage(); return 1; }
+    if (!opt.nnue.empty() && !(nnue_load(opt.nnue) && set_eval_backend(true))) {
+        std::cerr << "Cannot load network " << opt.nnue << "\n";
+        return 1;
+    }
+    std::signal(SIGPIPE, SIG_IGN);
+    return opt.listenPort > 0 ? run_coordinator(opt) : run_worker(opt);
+}
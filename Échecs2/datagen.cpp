@@ -0,0 +1,202 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+#include <atomic>
+#include <thread>
+#include <random>
+#include "engine2.hpp"
+#include "packed.hpp"
+
+using namespace cechess;
+
+// =========================
+// Génération de données d'entraînement (auto-parties)
+// =========================
+// Chaque worker joue des parties contre lui-même : quelques coups aléatoires
+// pour varier les ouvertures, puis une recherche à budget fixe par coup.
+// Positions retenues : hors échec, meilleur coup calme, score non mat.
+// Le résultat de la partie est connu à la fin : chaque partie est écrite
+// d'un bloc, au format compact de packed.hpp (32 octets par position).
+// --dump relit un fichier et affiche fen;score;résultat.
+
+struct DatagenOptions {
+    std::string out, dump, nnue;
+    long long games = 1000;
+    int workers = 1;
+    int hashMb = 16;
+    SearchLimits limits;       // par coup ; défaut : 5000 nœuds
+    int randomPlies = 8;       // coups aléatoires en début de partie
+    int maxPlies = 400;        // nulle par arbitrage au-delà
+    int winScore = 2000;       // arbitrage : |score| >= winScore ...
+    int winPlies = 6;          // ... pendant autant de demi-coups consécutifs
+    U64 seed = 0;              // 0 = aléatoire
+    long long dumpCount = 0;   // --dump : 0 = tout
+};
+
+static void usage() {
+    std::cout << "Usage: datagen --out data.bin [--games N] [--workers N] [--nodes N | --depth N]\n"
+                 "               [--random-plies N] [--max-plies N] [--win-score cp] [--win-plies N]\n"
+                 "               [--hash MB] [--seed N] [--nnue file]\n"
+                 "       datagen --dump data.bin [--count N]\n"
+                 "  sortie ajoutée à la fin du fichier ; --workers 0 = un par coeur\n";
+}
+
+// une partie ; false si les coups aléatoires l'ont déjà terminée
+static bool play_game(Engine &e, const DatagenOptions &opt, std::mt19937_64 &rng, std::vector<PackedPos> &recs) {
+    Position p;
+    set_startpos(p);
+    std::vector<U64> keys{p.key};
+    int moves[256];
+    for (int i = 0; i < opt.randomPlies; ++i) {
+        int n = generate_legal_moves(p, moves);
+        if (n == 0) return false;
+        Undo u;
+        make_move(p, moves[rng() % n], u);
+        keys.push_back(p.key);
+    }
+
+    tt_clear(*e.tt);
+    std::vector<Position> kept;
+    std::vector<int> scores;
+    int result = RESULT_DRAW, winStreak = 0, lossStreak = 0;
+    for (int ply = 0; ; ++ply) {
+        int n = generate_legal_moves(p, moves);
+        if (n == 0) {
+            if (in_check(p, p.stm)) result = p.stm == WHITE ? RESULT_BLACK : RESULT_WHITE;
+            break;
+        }
+        int reps = 0;
+        for (size_t i = keys.size(); i-- > 0 && keys.size() - 1 - i <= (size_t)p.halfmove; )
+            if (keys[i] == p.key) ++reps;
+        if (p.halfmove >= 100 || reps >= 3 || insufficient_material(p) || ply >= opt.maxPlies) break;
+
+        set_history(e, keys.data(), (int)keys.size());
+        e.stop = false;
+        int best = 0;
+        int score = search_best_move(e, p, opt.limits, best);
+        if (!best) best = moves[0];
+        int white = p.stm == WHITE ? score : -score;
+
+        // arbitrage : les deux camps voient le même vainqueur assez longtemps
+        winStreak  = white >=  opt.winScore ? winStreak + 1  : 0;
+        lossStreak = white <= -opt.winScore ? lossStreak + 1 : 0;
+        if (winStreak >= opt.winPlies)  { result = RESULT_WHITE; break; }
+        if (lossStreak >= opt.winPlies) { result = RESULT_BLACK; break; }
+
+        bool quiet = !(best & (MF_CAPTURE | MF_PROMO));
+        if (quiet && !in_check(p, p.stm) && !mate_in(score, (int)keys.size() - 1)) {
+            kept.push_back(p);
+            scores.push_back(white);
+        }
+
+        Undo u;
+        make_move(p, best, u);
+        keys.push_back(p.key);
+    }
+
+    for (size_t i = 0; i < kept.size(); ++i) recs.push_back(pack_position(kept[i], scores[i], result));
+    return true;
+}
+
+static int dump(const DatagenOptions &opt) {
+    std::vector<PackedPos> recs;
+    if (!packed_load(opt.dump, recs)) {
+        std::cerr << "Cannot open " << opt.dump << "\n";
+        return 1;
+    }
+    static const char *res[3] = {"0-1", "1/2-1/2", "1-0"};
+    long long shown = 0, bad = 0;
+    for (const PackedPos &r : recs) {
+        if (opt.dumpCount && shown >= opt.dumpCount) break;
+        Position p;
+        int score, result;
+        if (!unpack_position(r, p, score, result)) { ++bad; continue; }
+        std::cout << get_fen(p) << ";" << score << ";" << res[result] << "\n";
+        ++shown;
+    }
+    std::cerr << "Records " << recs.size() << "  invalid " << bad << "\n";
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    DatagenOptions opt;
+    bool limited = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        bool hasArg = i + 1 < argc;
+        if      (a == "--out"          && hasArg) opt.out = argv[++i];
+        else if (a == "--dump"         && hasArg) opt.dump = argv[++i];
+        else if (a == "--count"        && hasArg) opt.dumpCount = std::atoll(argv[++i]);
+        else if (a == "--games"        && hasArg) opt.games = std::atoll(argv[++i]);
+        else if (a == "--workers"      && hasArg) opt.workers = std::atoi(argv[++i]);
+        else if (a == "--hash"         && hasArg) opt.hashMb = std::atoi(argv[++i]);
+        else if (a == "--nodes"        && hasArg) { opt.limits.nodes = std::strtoull(argv[++i], nullptr, 10); limited = true; }
+        else if (a == "--depth"        && hasArg) { opt.limits.depth = std::atoi(argv[++i]); limited = true; }
+        else if (a == "--random-plies" && hasArg) opt.randomPlies = std::atoi(argv[++i]);
+        else if (a == "--max-plies"    && hasArg) opt.maxPlies = std::atoi(argv[++i]);
+        else if (a == "--win-score"    && hasArg) opt.winScore = std::atoi(argv[++i]);
+        else if (a == "--win-plies"    && hasArg) opt.winPlies = std::atoi(argv[++i]);
+        else if (a == "--seed"         && hasArg) opt.seed = std::strtoull(argv[++i], nullptr, 10);
+        else if (a == "--nnue"         && hasArg) opt.nnue = argv[++i];
+        else if (a == "-h" || a == "--help") { usage(); return 0; }
+        else { usage(); return 1; }
+    }
+    if (!opt.dump.empty()) return dump(opt);
+    if (opt.out.empty()) { usage(); return 1; }
+    if (!limited) opt.limits.nodes = 5000;
+    if (!opt.nnue.empty() && !(nnue_load(opt.nnue) && set_eval_backend(true))) {
+        std::cerr << "Cannot load network " << opt.nnue << "\n";
+        return 1;
+    }
+    if (opt.workers <= 0) opt.workers = (int)std::max(1u, std::thread::hardware_concurrency());
+    if (!opt.seed) opt.seed = std::random_device{}();
+
+    PackedWriter writer;
+    if (!packed_open(writer, opt.out)) {
+        std::cerr << "Cannot write " << opt.out << "\n";
+        return 1;
+    }
+
+    std::vector<std::unique_ptr<Engine>> engines;
+    for (int i = 0; i < opt.workers; ++i) {
+        engines.push_back(std::make_unique<Engine>());
+        tt_resize(*engines.back()->tt, std::max(opt.hashMb, 1));
+        set_threads(*engines.back(), 1);
+    }
+
+    std::atomic<long long> next{0}, done{0};
+    std::atomic<bool> failed{false};
+    auto t0 = std::chrono::steady_clock::now();
+    auto work = [&](Engine &e) {
+        std::vector<PackedPos> recs;
+        for (long long g; !failed && (g = next++) < opt.games; ) {
+            // une graine par partie : résultats reproductibles quel que soit l'ordonnancement
+            std::mt19937_64 rng(opt.seed + (U64)g * 0x9E3779B97F4A7C15ULL);
+            recs.clear();
+            while (!play_game(e, opt, rng, recs)) {}
+            if (!packed_write(writer, recs.data(), recs.size())) failed = true;
+            long long d = ++done;
+            if (d % 100 == 0) {
+                double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+                std::cerr << "games " << d << "  positions " << writer.written
+                          << "  games/s " << std::fixed << std::setprecision(1) << d / sec << "\n";
+            }
+        }
+    };
+    std::vector<std::thread> pool;
+    for (int w = 1; w < opt.workers; ++w) pool.emplace_back(work, std::ref(*engines[w]));
+    work(*engines[0]);
+    for (auto &th : pool) th.join();
+
+    if (!packed_close(writer) || failed) {
+        std::cerr << "Write error on " << opt.out << "\n";
+        return 1;
+    }
+    double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    std::cerr << "Games " << done << "  positions " << writer.written
+              << "  time " << std::fixed << std::setprecision(1) << sec << "s\n";
+    return 0;
+}
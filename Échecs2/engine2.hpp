@@ -4,6 +4,28 @@
 #include <chrono>
 #include <limits>
 #include <string>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <cstdlib>
+#include <new>
+#ifdef __linux__
+#include <sys/mman.h>  // madvise(MADV_HUGEPAGE)
+#endif
+#include <sstream>
+#ifdef USE_PEXT
+#include <immintrin.h> // _pext_u64 (BMI2, compiler avec -mbmi2)
+#endif
+#ifdef USE_SYZYGY
+#include "tbprobe.h"   // Fathom (tbprobe.c à compiler avec le moteur)
+#endif
+#ifdef PROFILE
+#include <mutex>
+#include <cstdio>
+#endif
+#include "nnue.hpp"
+#include "eval_weights.hpp" // MAT_*, PST_*, EVAL_W
 
 namespace cechess {
 
@@ -11,10 +33,11 @@ using U64 = std::uint64_t;
 constexpr int INF  = 30000;
 constexpr int MATE = 29000;
 constexpr int FUTILITY_MARGIN = 150;
+constexpr int ASPIRATION_DELTA = 25;  // demi-fenêtre initiale à la racine
 
 enum Color { WHITE=0, BLACK=1 };
 enum PieceType { PAWN=0, KNIGHT, BISHOP, ROOK, QUEEN, KING, NO_PIECE_TYPE };
-enum Piece {
+enum Piece : uint8_t {
     EMPTY=0,
     W_PAWN, W_KNIGHT, W_BISHOP, W_ROOK, W_QUEEN, W_KING,
     B_PAWN, B_KNIGHT, B_BISHOP, B_ROOK, B_QUEEN, B_KING
@@ -34,9 +57,9 @@ inline int piece_color(Piece p){ return p>=B_PAWN; }
 inline int piece_type(Piece p){ return p ? ((p-1)%6) : NO_PIECE_TYPE; }
 inline Piece make_piece(Color c, PieceType t){ return t==NO_PIECE_TYPE ? EMPTY : Piece(1+t+6*c); }
 
-inline int sq(int f,int r){ return r*8+f; }
-inline int file_of(int s){ return s & 7; }
-inline int rank_of(int s){ return s >> 3; }
+constexpr int sq(int f,int r){ return r*8+f; }
+constexpr int file_of(int s){ return s & 7; }
+constexpr int rank_of(int s){ return s >> 3; }
 
 inline int move_from(int m){ return m & 63; }
 inline int move_to(int m){ return (m >> 6) & 63; }
@@ -48,118 +71,266 @@ inline int make_move_int(int from,int to,int promo=0,int flags=0){
     return from | (to<<6) | (promo<<12) | flags;
 }
 
-inline U64 bb_one(int s){ return 1ULL << s; }
-inline int pop_lsb(U64 &b){ int s=__builtin_ctzll(b); b &= b-1; return s; }
-inline int bb_count(U64 b){ return __builtin_popcountll(b); }
+constexpr U64 bb_one(int s){ return 1ULL << s; }
+constexpr int pop_lsb(U64 &b){ int s=__builtin_ctzll(b); b &= b-1; return s; }
+constexpr int bb_count(U64 b){ return __builtin_popcountll(b); }
+
+// --- Instrumentation (compiler avec -DPROFILE) ---
+// Compteurs par thread ; une fonction sur 64 appels est chronométrée et le
+// temps total est extrapolé. Sans PROFILE les macros ne génèrent rien.
+
+enum ProfEvent {
+    PROF_MOVEGEN, PROF_MAKE, PROF_UNMAKE, PROF_EVAL, PROF_TT_PROBE, PROF_TT_STORE,
+    PROF_QNODE, PROF_NULL_CUT, PROF_LMR_RESEARCH, PROF_FUTILITY, PROF_EVENTS
+};
+
+#ifdef PROFILE
+constexpr U64 PROF_SAMPLE = 64;
+
+struct ProfData {
+    U64 count[PROF_EVENTS]{};
+    U64 samples[PROF_EVENTS]{};
+    U64 sampled_ns[PROF_EVENTS]{};
+};
+
+static thread_local ProfData prof_tls;   // thread courant
+static ProfData prof_total;              // somme des threads d'une recherche
+static std::mutex prof_mtx;
+
+struct ProfScope {
+    ProfEvent ev;
+    bool timed;
+    std::chrono::steady_clock::time_point t0;
+    explicit ProfScope(ProfEvent e) : ev(e), timed(prof_tls.count[e]++ % PROF_SAMPLE == 0) {
+        if(timed) t0 = std::chrono::steady_clock::now();
+    }
+    ~ProfScope(){
+        if(!timed) return;
+        prof_tls.samples[ev]++;
+        prof_tls.sampled_ns[ev] += (U64)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                       std::chrono::steady_clock::now() - t0).count();
+    }
+};
+
+#define PROF_SCOPE(e) ProfScope prof_scope_(e)
+#define PROF_EVENT(e) (prof_tls.count[e]++)
+
+inline void prof_reset_thread(){ prof_tls = ProfData(); }
+
+inline void prof_flush_thread(){
+    std::lock_guard<std::mutex> lk(prof_mtx);
+    for(int i=0;i<PROF_EVENTS;i++){
+        prof_total.count[i]      += prof_tls.count[i];
+        prof_total.samples[i]    += prof_tls.samples[i];
+        prof_total.sampled_ns[i] += prof_tls.sampled_ns[i];
+    }
+    prof_tls = ProfData();
+}
+
+// coût d'une mesure à vide, retiré de chaque échantillon
+inline double prof_timer_overhead_ns(){
+    static double overhead = [](){
+        U64 best = ~0ULL;
+        for(int i=0;i<1000;i++){
+            auto a = std::chrono::steady_clock::now();
+            auto b = std::chrono::steady_clock::now();
+            best = std::min<U64>(best, (U64)std::chrono::duration_cast<std::chrono::nanoseconds>(b - a).count());
+        }
+        return double(best);
+    }();
+    return overhead;
+}
+
+// rapport sur stderr (stdout sert au protocole UCI), puis remise à zéro
+inline void prof_report(double search_ms){
+    static const char *NAMES[PROF_EVENTS] = {
+        "movegen", "make", "unmake", "eval", "tt probe", "tt store",
+        "qsearch nodes", "null-move cuts", "lmr re-search", "futility prunes"
+    };
+    std::lock_guard<std::mutex> lk(prof_mtx);
+    std::fprintf(stderr, "profile (%.0f ms)\n%-16s %14s %10s %12s %7s\n",
+                 search_ms, "event", "count", "ns/call", "est. ms", "%");
+    for(int i=0;i<PROF_EVENTS;i++){
+        const ProfData &d = prof_total;
+        if(d.samples[i] == 0){
+            std::fprintf(stderr, "%-16s %14llu\n", NAMES[i], (unsigned long long)d.count[i]);
+            continue;
+        }
+        double ns = std::max(0.0, double(d.sampled_ns[i]) / d.samples[i] - prof_timer_overhead_ns());
+        double ms = ns * d.count[i] / 1e6;
+        std::fprintf(stderr, "%-16s %14llu %10.1f %12.1f %6.1f%%\n", NAMES[i],
+                     (unsigned long long)d.count[i], ns, ms, search_ms > 0 ? 100 * ms / search_ms : 0.0);
+    }
+    prof_total = ProfData();
+}
+#else
+#define PROF_SCOPE(e) ((void)0)
+#define PROF_EVENT(e) ((void)0)
+inline void prof_reset_thread(){}
+inline void prof_flush_thread(){}
+inline void prof_report(double){}
+#endif
 
 // --- Structures ---
 
 struct Position {
-    Piece board[64]{};
-    U64 bb[2][6]{};      // [color][pieceType]
-    U64 occ[2]{}, occ_all{};
+    Piece board[64]{};   // un octet par case
+    U64 by_type[6]{};    // [pieceType], deux camps confondus ; voir pieces()
+    U64 occ[2]{};        // par camp ; voir occupied()
     Color stm = WHITE;
     int castling = 0;    // bits: 1=WK,2=WQ,4=BK,8=BQ
     int ep = -1;
     int halfmove = 0, fullmove = 1;
     U64 key = 0;
+    U64 pawn_key = 0;               // zobrist des seuls pions (cache de pions)
+    // termes linéaires maintenus par add/remove/move_piece
+    int psq_mg[2]{}, psq_eg[2]{};   // matériel + PST par camp
+    int phase = 0;                  // non borné (promotions)
 };
 
+inline U64 pieces(const Position &p, int c, int t){ return p.by_type[t] & p.occ[c]; }
+inline U64 occupied(const Position &p){ return p.occ[0] | p.occ[1]; }
+
+// état non réversible, restauré tel quel par unmake_move (16 octets)
 struct Undo {
-    Position prev;       // snapshot complet
+    U64 key = 0;
+    Piece captured = EMPTY;
+    uint8_t castling = 0;
+    int8_t ep = -1;
+    int16_t halfmove = 0;
 };
 
 // --- Transposition table ---
 
+// Partagée par tous les threads, sans verrou : une entrée tient dans un seul
+// mot atomique de 64 bits, lu et écrit d'un bloc, donc jamais déchiré.
+// Mot = coup 16 bits (from | to<<6 | promo<<12, drapeaux recalculés depuis
+// la position) | score 16 | profondeur 8 | génération+borne 8 (gen<<2 |
+// flag+1 ; 0 = vide) | vérification 16 (bits bas de la clé : les bits hauts
+// choisissent le bucket). Une collision sur 16 bits reste possible : le coup
+// est revalidé par move_is_legal avant d'être joué.
 struct TTEntry {
-    U64 key = 0;
-    int16_t score = 0;
-    uint16_t move = 0;
-    int8_t depth = 0;
-    uint8_t flag = 0;
+    std::atomic<U64> data{0};
 };
 
-constexpr int TT_BITS = 20; // 1M entrées
-constexpr int TT_SIZE = 1<<TT_BITS;
-static TTEntry TT[TT_SIZE];
+// 8 entrées par bucket = une ligne de cache de 64 octets
+constexpr int TT_BUCKET_SIZE = 8;
+struct alignas(64) TTBucket {
+    TTEntry e[TT_BUCKET_SIZE];
+};
+static_assert(sizeof(TTBucket) == 64, "8 entrées de 8 octets par bucket");
 
-// --- Heuristiques de recherche ---
+constexpr size_t TT_DEFAULT_MB = 16;
 
-constexpr int MAX_PLY = 64;
-static int killer_moves[2][MAX_PLY]{};      // [2 killers][ply]
-static int history_heur[2][64][64]{};       // [color][from][to]
+struct TranspositionTable {
+    TTBucket *buckets = nullptr;
+    size_t count = 0;       // nombre de buckets
+    size_t bytes = 0;
+    uint8_t generation = 0; // incrémentée à chaque recherche (6 bits utiles)
+
+    TranspositionTable() = default;
+    TranspositionTable(const TranspositionTable &) = delete;
+    TranspositionTable &operator=(const TranspositionTable &) = delete;
+    ~TranspositionTable(){ std::free(buckets); }
+};
+static TranspositionTable TT;   // table du moteur principal (main2, UCI)
 
-// --- Historique de partie + recherche ---
+// --- Historique de partie ---
 
 static U64 game_history[4096]{}; // historique réel de la partie
 static int game_ply = 0;
 
-static U64 rep_history[4096]{};  // historique pour la recherche
-
 // --- Zobrist & attaques ---
-
-static U64 zob_piece[2][6][64], zob_castle[16], zob_ep[9], zob_side;
-static U64 knight_att[64], king_att[64];
-
-// MVV-LVA
-static int MVV_LVA[7][7]; // [victimType][attackerType], 0..5 = pièces, 6 = empty
+// Toutes les tables sont calculées à la compilation (fonctions constexpr) :
+// elles vivent dans la section en lecture seule de l'exécutable, partagée
+// entre processus par le cache de pages, sans aucune initialisation.
 
 // Valeurs de base
-static const int VAL[6] = {100,320,330,500,900,0};
+static constexpr int VAL[6] = {100,320,330,500,900,0};
 
-// --- Initialisations ---
+struct ZobristKeys {
+    U64 piece[2][6][64];
+    U64 castle[16];
+    U64 ep[9];
+    U64 side;
+};
 
-inline void init_zobrist(){
+constexpr ZobristKeys make_zobrist(){
+    ZobristKeys z{};
     std::uint64_t x=88172645463393265ULL;
     auto rnd=[&](){ x^=x<<7; x^=x>>9; return x; };
     for(int c=0;c<2;c++)
         for(int t=0;t<6;t++)
             for(int s=0;s<64;s++)
-                zob_piece[c][t][s]=rnd();
-    for(int i=0;i<16;i++) zob_castle[i]=rnd();
-    for(int i=0;i<9;i++)  zob_ep[i]=rnd();
-    zob_side=rnd();
+                z.piece[c][t][s]=rnd();
+    for(int i=0;i<16;i++) z.castle[i]=rnd();
+    for(int i=0;i<9;i++)  z.ep[i]=rnd();
+    z.side=rnd();
+    return z;
 }
 
-inline void init_leapers(){
+struct LeaperAttacks {
+    U64 knight[64], king[64];
+    U64 pawn[2][64];  // [color][case] cases attaquées par un pion
+};
+
+constexpr LeaperAttacks make_leapers(){
+    LeaperAttacks l{};
+    constexpr int nf[8]={1,2,2,1,-1,-2,-2,-1};
+    constexpr int nr[8]={2,1,-1,-2,-2,-1,1,2};
     for(int s=0;s<64;s++){
         int f=file_of(s), r=rank_of(s);
-        U64 n=0,k=0;
-        int nf[8]={1,2,2,1,-1,-2,-2,-1};
-        int nr[8]={2,1,-1,-2,-2,-1,1,2};
         for(int i=0;i<8;i++){
             int ff=f+nf[i], rr=r+nr[i];
             if(ff>=0&&ff<8&&rr>=0&&rr<8)
-                n |= bb_one(sq(ff,rr));
+                l.knight[s] |= bb_one(sq(ff,rr));
         }
         for(int ff=f-1;ff<=f+1;ff++)
             for(int rr=r-1;rr<=r+1;rr++)
                 if(ff>=0&&ff<8&&rr>=0&&rr<8&&(ff!=f||rr!=r))
-                    k |= bb_one(sq(ff,rr));
-        knight_att[s]=n;
-        king_att[s]=k;
+                    l.king[s] |= bb_one(sq(ff,rr));
+        for(int df=-1; df<=1; df+=2){
+            int ff=f+df; if(ff<0||ff>7) continue;
+            if(r<7) l.pawn[WHITE][s] |= bb_one(sq(ff,r+1));
+            if(r>0) l.pawn[BLACK][s] |= bb_one(sq(ff,r-1));
+        }
     }
+    return l;
 }
 
-inline void init_mvv_lva(){
+// [victimType][attackerType], 0..5 = pièces, 6 = empty
+struct MvvLva { int v[7][7]; };
+
+constexpr MvvLva make_mvv_lva(){
+    MvvLva t{};
     for(int victim=0; victim<7; ++victim){
         for(int attacker=0; attacker<7; ++attacker){
             int v = (victim  <6 ? VAL[victim]  : 0);
             int a = (attacker<6 ? VAL[attacker]: 1);
-            MVV_LVA[victim][attacker] = v*10 - a;
+            t.v[victim][attacker] = v*10 - a;
         }
     }
+    return t;
 }
 
-inline void init_all(){
-    init_zobrist();
-    init_leapers();
-    init_mvv_lva();
-}
+static constexpr ZobristKeys   ZOBRIST = make_zobrist();
+static constexpr LeaperAttacks LEAPERS = make_leapers();
+static constexpr MvvLva        MVV_LVA_TABLE = make_mvv_lva();
 
-// --- Attaques sliding ---
+static constexpr auto &zob_piece  = ZOBRIST.piece;
+static constexpr auto &zob_castle = ZOBRIST.castle;
+static constexpr auto &zob_ep     = ZOBRIST.ep;
+static constexpr U64   zob_side   = ZOBRIST.side;
+static constexpr auto &knight_att = LEAPERS.knight;
+static constexpr auto &king_att   = LEAPERS.king;
+static constexpr auto &pawn_att   = LEAPERS.pawn;
+static constexpr auto &MVV_LVA    = MVV_LVA_TABLE.v;
 
-inline U64 rook_attacks(int sq0,U64 occ){
+
+// --- Attaques sliding (magic bitboards) ---
+
+// Parcours rayon par rayon : sert uniquement à remplir les tables magiques.
+constexpr U64 rook_attacks_slow(int sq0,U64 occ){
     U64 a=0;
     int f=file_of(sq0), r=rank_of(sq0);
     for(int rr=r+1;rr<8;rr++){int s=sq(f,rr); a|=bb_one(s); if(occ&bb_one(s))break;}
@@ -169,7 +340,7 @@ inline U64 rook_attacks(int sq0,U64 occ){
     return a;
 }
 
-inline U64 bishop_attacks(int sq0,U64 occ){
+constexpr U64 bishop_attacks_slow(int sq0,U64 occ){
     U64 a=0;
     int f=file_of(sq0), r=rank_of(sq0);
     for(int ff=f+1,rr=r+1;ff<8&&rr<8;ff++,rr++){int s=sq(ff,rr); a|=bb_one(s); if(occ&bb_one(s))break;}
@@ -179,10 +350,163 @@ inline U64 bishop_attacks(int sq0,U64 occ){
     return a;
 }
 
+struct Magic {
+    U64 mask;         // cases pertinentes (bords exclus)
+    U64 magic;
+    unsigned offset;  // début de la sous-table de la case
+    int shift;
+};
+
+// Nombres magiques trouvés hors-ligne (recherche aléatoire, shift fixe = 64 - bits(mask)).
+static constexpr U64 ROOK_MAGIC_NUMS[64] = {
+    0x1080004008801020ULL, 0x0840092002C03000ULL, 0x1900200010400900ULL, 0x0880100008000480ULL,
+    0x4200100420080200ULL, 0x8100020100080400ULL, 0x0200040110886200ULL, 0x0200008040220411ULL,
+    0x0404800084400220ULL, 0x0000401000402000ULL, 0x0086001081220440ULL, 0x0408800800100280ULL,
+    0x000A001201040820ULL, 0x8848800200840080ULL, 0x4001000100040200ULL, 0x0442000102105084ULL,
+    0x9080010020804100ULL, 0x0040404000201009ULL, 0x0000808010002009ULL, 0x2200090021D00100ULL,
+    0x0008008008040080ULL, 0x0004004002010040ULL, 0x0011040008015042ULL, 0x00000A0001768104ULL,
+    0x0000800080204009ULL, 0x2010004140002001ULL, 0x9800200280100080ULL, 0x1000100080080080ULL,
+    0x0442000A00049020ULL, 0x2100040080020080ULL, 0x0800120400900148ULL, 0x0010040A00128541ULL,
+    0x2800804000800030ULL, 0x1010002000400041ULL, 0x4000200011004100ULL, 0x0610008410800800ULL,
+    0x0400802402800800ULL, 0xC100020080800400ULL, 0x0002000802000401ULL, 0x0182085882000401ULL,
+    0x0220204000808000ULL, 0x2860100040024022ULL, 0x0001002004110040ULL, 0x99101042000A0020ULL,
+    0x0004080004008080ULL, 0x0010040002008080ULL, 0x2012004881020004ULL, 0x8300842444820011ULL,
+    0x0088403882010200ULL, 0x0820400080210100ULL, 0x0110910040A00300ULL, 0x0801100280080480ULL,
+    0x0242009008200600ULL, 0x1002000489500200ULL, 0x0040800200010080ULL, 0x0091800041000080ULL,
+    0x0000209300488001ULL, 0x04C1002414824001ULL, 0x020020000B001041ULL, 0x7000100004200901ULL,
+    0x8002002004100802ULL, 0x30010002084C0007ULL, 0x0888221800813004ULL, 0x4000002840840112ULL,
+};
+static constexpr U64 BISHOP_MAGIC_NUMS[64] = {
+    0xA010041108003100ULL, 0x006082020A002900ULL, 0x6810010619200000ULL, 0x08281A0520000408ULL,
+    0x0001104001000400ULL, 0x0018901008048400ULL, 0x00040A0210245280ULL, 0x000200210808A402ULL,
+    0x9140048410821200ULL, 0x0800091010820041ULL, 0x20504804832202C0ULL, 0x0100091401081000ULL,
+    0x8021011140000012ULL, 0x0810020804450400ULL, 0x208B0542109008A2ULL, 0x0080084A08040204ULL,
+    0x0040E2A80811244CULL, 0x2505022008008108ULL, 0x0430220100420040ULL, 0x010A040420220040ULL,
+    0x1105000290400000ULL, 0x0093001200822120ULL, 0x4000A62048043004ULL, 0x280120048A015004ULL,
+    0x006090002A020814ULL, 0x44042000240800D0ULL, 0x01102800040A4400ULL, 0x1004080080220040ULL,
+    0x0001001011004024ULL, 0x0010044000805040ULL, 0x0914041200820100ULL, 0x0004821012821480ULL,
+    0x0024040500C05021ULL, 0x0088611002080200ULL, 0x0116080A00040020ULL, 0x4000020080080080ULL,
+    0x2450450140840040ULL, 0x0000880201484100ULL, 0x0222020404020092ULL, 0x8081110600002E00ULL,
+    0x2842101105000801ULL, 0x1100809008001025ULL, 0x00020202221C0400ULL, 0x0422014022009020ULL,
+    0x0210046102100C00ULL, 0xC004008082029102ULL, 0x00AA461801101200ULL, 0x0404080080201108ULL,
+    0x020542108C205002ULL, 0x0410544804100100ULL, 0x0040910841100000ULL, 0x0400200042021100ULL,
+    0x00004204850400C0ULL, 0x0200100410A42102ULL, 0x1040020801210102ULL, 0x0805040410420000ULL,
+    0x2884804130100200ULL, 0x800C262201242000ULL, 0x1058000194108800ULL, 0x0014221054420204ULL,
+    0x0104000012A02200ULL, 0x0200881003300100ULL, 0x0140400202840100ULL, 0x0402020801010201ULL,
+};
+
+inline unsigned magic_index(const Magic &m, U64 occ){
+#ifdef USE_PEXT
+    return (unsigned)_pext_u64(occ, m.mask);
+#else
+    return (unsigned)(((occ & m.mask) * m.magic) >> m.shift);
+#endif
+}
+
+template<int Entries>
+struct MagicTable {
+    Magic magics[64];
+    U64 attacks[Entries];
+};
+
+template<int Entries>
+constexpr MagicTable<Entries> make_magic_table(const U64 *nums, bool rook){
+    MagicTable<Entries> t{};
+    unsigned cur = 0;
+    for(int s=0;s<64;s++){
+        int f=file_of(s), r=rank_of(s);
+        // bords inutiles pour l'occupation (la case du bord est toujours attaquée)
+        U64 edges = ((0xFFULL | (0xFFULL<<56)) & ~(0xFFULL<<(8*r))) |
+                    ((0x0101010101010101ULL | (0x8080808080808080ULL)) & ~(0x0101010101010101ULL<<f));
+        Magic &m = t.magics[s];
+        m.mask    = (rook ? rook_attacks_slow(s,0) : bishop_attacks_slow(s,0)) & ~edges;
+        m.magic   = nums[s];
+        m.shift   = 64 - bb_count(m.mask);
+        m.offset  = cur;
+        // Carry-Rippler : énumère tous les sous-ensembles du masque
+        // (dans l'ordre croissant des index pext)
+        U64 sub = 0;
+        [[maybe_unused]] unsigned n = 0;
+        do{
+#ifdef USE_PEXT
+            unsigned idx = n++;
+#else
+            unsigned idx = (unsigned)((sub * m.magic) >> m.shift);
+#endif
+            t.attacks[cur + idx] = rook ? rook_attacks_slow(s,sub) : bishop_attacks_slow(s,sub);
+            sub = (sub - m.mask) & m.mask;
+        }while(sub);
+        cur += 1u << bb_count(m.mask);
+    }
+    return t;
+}
+
+static constexpr MagicTable<0x19000> ROOK_MAGICS   = make_magic_table<0x19000>(ROOK_MAGIC_NUMS, true);   // 102400 entrées
+static constexpr MagicTable<0x1480>  BISHOP_MAGICS = make_magic_table<0x1480>(BISHOP_MAGIC_NUMS, false); // 5248 entrées
+
+// cases strictement entre a et b / ligne entière passant par a et b (0 si non alignées)
+struct LineTables { U64 between[64][64], line[64][64]; };
+
+constexpr LineTables make_lines(){
+    LineTables l{};
+    for(int a=0;a<64;a++){
+        U64 ra=rook_attacks_slow(a,0), ba=bishop_attacks_slow(a,0);
+        for(int b=0;b<64;b++){
+            if(a==b) continue;
+            if(ra & bb_one(b)){
+                l.line[a][b]    = (ra & rook_attacks_slow(b,0)) | bb_one(a) | bb_one(b);
+                l.between[a][b] = rook_attacks_slow(a,bb_one(b)) & rook_attacks_slow(b,bb_one(a));
+            }else if(ba & bb_one(b)){
+                l.line[a][b]    = (ba & bishop_attacks_slow(b,0)) | bb_one(a) | bb_one(b);
+                l.between[a][b] = bishop_attacks_slow(a,bb_one(b)) & bishop_attacks_slow(b,bb_one(a));
+            }
+        }
+    }
+    return l;
+}
+
+static constexpr LineTables LINES = make_lines();
+static constexpr auto &between_bb = LINES.between;
+static constexpr auto &line_bb    = LINES.line;
+
+inline U64 rook_attacks(int sq0,U64 occ){
+    const Magic &m = ROOK_MAGICS.magics[sq0];
+    return ROOK_MAGICS.attacks[m.offset + magic_index(m,occ)];
+}
+
+inline U64 bishop_attacks(int sq0,U64 occ){
+    const Magic &m = BISHOP_MAGICS.magics[sq0];
+    return BISHOP_MAGICS.attacks[m.offset + magic_index(m,occ)];
+}
+
 inline U64 queen_attacks(int sq0,U64 occ){
     return rook_attacks(sq0,occ) | bishop_attacks(sq0,occ);
 }
 
+// --- PST (utilisées par l'évaluation incrémentale) ---
+
+// poids de phase par type de pièce (24 = tout le matériel)
+static constexpr int PHASE_W[6] = {0,1,1,2,4,0};
+
+constexpr int pst_idx(int c,int s){ return c==WHITE ? s : 63-s; }
+
+// matériel + PST (eval_weights.hpp) fusionnés, indexés par camp et case réelle :
+// une seule lecture par pièce ajoutée, retirée ou déplacée
+struct PsqTable { int mg[2][6][64], eg[2][6][64]; };
+
+constexpr PsqTable make_psq(){
+    PsqTable t{};
+    for(int c=0;c<2;c++)
+        for(int pt=0;pt<6;pt++)
+            for(int s=0;s<64;s++){
+                t.mg[c][pt][s] = MAT_MG[pt] + PST_MG[pt][pst_idx(c,s)];
+                t.eg[c][pt][s] = MAT_EG[pt] + PST_EG[pt][pst_idx(c,s)];
+            }
+    return t;
+}
+
+static constexpr PsqTable PSQ = make_psq();
+
 // --- Occupancy & zobrist ---
 
 inline U64 compute_key(const Position &p){
@@ -198,19 +522,34 @@ inline U64 compute_key(const Position &p){
     return k;
 }
 
-inline void update_occupancy(Position &p){
-    p.occ[0]=p.occ[1]=p.occ_all=0;
+// recalcule un accumulateur NNUE depuis les bitboards
+inline void nnue_refresh(Accumulator &a, const Position &p){
+    nnue_reset(a);
     for(int c=0;c<2;c++)
         for(int t=0;t<6;t++)
-            p.bb[c][t]=0;
+            for(U64 b=pieces(p,c,t); b; )
+                nnue_add(a, c, t, pop_lsb(b));
+}
+
+// reconstruit bitboards et termes incrémentaux depuis board[]
+inline void update_occupancy(Position &p){
+    p.occ[0]=p.occ[1]=0;
+    for(int t=0;t<6;t++)
+        p.by_type[t]=0;
+    p.psq_mg[0]=p.psq_mg[1]=p.psq_eg[0]=p.psq_eg[1]=0;
+    p.phase=0;
+    p.pawn_key=0;
     for(int s=0;s<64;s++){
         Piece pc=p.board[s]; if(pc==EMPTY)continue;
         int c=piece_color(pc), t=piece_type(pc);
         U64 b=bb_one(s);
-        p.bb[c][t] |= b;
-        p.occ[c]   |= b;
+        p.by_type[t] |= b;
+        p.occ[c]     |= b;
+        p.psq_mg[c] += PSQ.mg[c][t][s];
+        p.psq_eg[c] += PSQ.eg[c][t][s];
+        p.phase     += PHASE_W[t];
+        if(t==PAWN) p.pawn_key ^= zob_piece[c][PAWN][s];
     }
-    p.occ_all = p.occ[0] | p.occ[1];
 }
 
 // incrémental
@@ -220,10 +559,13 @@ inline void add_piece(Position &p, int s, Piece pc){
     int c = piece_color(pc);
     int t = piece_type(pc);
     U64 b = bb_one(s);
-    p.bb[c][t] |= b;
-    p.occ[c]   |= b;
-    p.occ_all  |= b;
+    p.by_type[t] |= b;
+    p.occ[c]     |= b;
     p.key ^= zob_piece[c][t][s];
+    p.psq_mg[c] += PSQ.mg[c][t][s];
+    p.psq_eg[c] += PSQ.eg[c][t][s];
+    p.phase     += PHASE_W[t];
+    if(t==PAWN) p.pawn_key ^= zob_piece[c][PAWN][s];
 }
 
 inline void remove_piece(Position &p, int s){
@@ -232,10 +574,13 @@ inline void remove_piece(Position &p, int s){
     int c = piece_color(pc);
     int t = piece_type(pc);
     U64 b = bb_one(s);
-    p.bb[c][t] &= ~b;
-    p.occ[c]   &= ~b;
-    p.occ_all  &= ~b;
+    p.by_type[t] &= ~b;
+    p.occ[c]     &= ~b;
     p.key ^= zob_piece[c][t][s];
+    p.psq_mg[c] -= PSQ.mg[c][t][s];
+    p.psq_eg[c] -= PSQ.eg[c][t][s];
+    p.phase     -= PHASE_W[t];
+    if(t==PAWN) p.pawn_key ^= zob_piece[c][PAWN][s];
     p.board[s] = EMPTY;
 }
 
@@ -245,14 +590,13 @@ inline void move_piece(Position &p, int from, int to){
     int c = piece_color(pc);
     int t = piece_type(pc);
     U64 fb = bb_one(from), tb = bb_one(to);
-    p.bb[c][t] ^= fb;
-    p.bb[c][t] |= tb;
-    p.occ[c]   ^= fb;
-    p.occ[c]   |= tb;
-    p.occ_all  ^= fb;
-    p.occ_all  |= tb;
+    p.by_type[t] ^= fb | tb;
+    p.occ[c]     ^= fb | tb;
     p.key ^= zob_piece[c][t][from];
     p.key ^= zob_piece[c][t][to];
+    p.psq_mg[c] += PSQ.mg[c][t][to] - PSQ.mg[c][t][from];
+    p.psq_eg[c] += PSQ.eg[c][t][to] - PSQ.eg[c][t][from];
+    if(t==PAWN) p.pawn_key ^= zob_piece[c][PAWN][from] ^ zob_piece[c][PAWN][to];
     p.board[from] = EMPTY;
     p.board[to]   = pc;
 }
@@ -280,10 +624,90 @@ inline void set_startpos(Position &p){
     p.key      = compute_key(p);
 }
 
+// position depuis une FEN ("pièces trait roques ep [halfmove fullmove]")
+inline bool set_fen(Position &p, const std::string &fen){
+    std::istringstream ss(fen);
+    std::string board, side, castle="-", ep="-";
+    int half=0, full=1;
+    if(!(ss >> board >> side)) return false;
+    ss >> castle >> ep;
+    if(!(ss >> half)) half = 0;
+    if(!(ss >> full)) full = 1;
+
+    Position np;
+    int r=7, f=0;
+    for(char ch : board){
+        if(ch=='/'){ if(f!=8) return false; r--; f=0; continue; }
+        if(ch>='1' && ch<='8'){ f += ch-'0'; if(f>8) return false; continue; }
+        static const char *pcs = "PNBRQKpnbrqk";
+        int i=0; while(pcs[i] && pcs[i]!=ch) i++;
+        if(!pcs[i] || r<0 || f>7) return false;
+        np.board[sq(f,r)] = Piece(i+1);
+        f++;
+    }
+    if(r!=0 || f!=8) return false;
+    update_occupancy(np);
+    if(bb_count(pieces(np,WHITE,KING))!=1 || bb_count(pieces(np,BLACK,KING))!=1) return false;
+
+    if(side=="w")      np.stm = WHITE;
+    else if(side=="b") np.stm = BLACK;
+    else return false;
+
+    np.castling = 0;
+    for(char ch : castle){
+        if(ch=='K') np.castling |= 1;
+        else if(ch=='Q') np.castling |= 2;
+        else if(ch=='k') np.castling |= 4;
+        else if(ch=='q') np.castling |= 8;
+    }
+    // droits incohérents (roi ou tour pas sur leur case) ignorés
+    if(np.board[sq(4,0)]!=W_KING) np.castling &= ~3;
+    if(np.board[sq(4,7)]!=B_KING) np.castling &= ~12;
+    if(np.board[sq(7,0)]!=W_ROOK) np.castling &= ~1;
+    if(np.board[sq(0,0)]!=W_ROOK) np.castling &= ~2;
+    if(np.board[sq(7,7)]!=B_ROOK) np.castling &= ~4;
+    if(np.board[sq(0,7)]!=B_ROOK) np.castling &= ~8;
+    np.ep = -1;
+    if(ep.size()==2 && ep[0]>='a' && ep[0]<='h' && (ep[1]=='3' || ep[1]=='6'))
+        np.ep = sq(ep[0]-'a', ep[1]-'1');
+    np.halfmove = half;
+    np.fullmove = full;
+    np.key = compute_key(np);
+    p = np;
+    return true;
+}
+
+inline std::string get_fen(const Position &p){
+    static const char *pcs = " PNBRQKpnbrqk";
+    std::string s;
+    for(int r=7;r>=0;r--){
+        int empty=0;
+        for(int f=0;f<8;f++){
+            Piece pc=p.board[sq(f,r)];
+            if(pc==EMPTY){ empty++; continue; }
+            if(empty){ s += char('0'+empty); empty=0; }
+            s += pcs[pc];
+        }
+        if(empty) s += char('0'+empty);
+        if(r) s += '/';
+    }
+    s += p.stm==WHITE ? " w " : " b ";
+    if(!p.castling) s += '-';
+    if(p.castling & 1) s += 'K';
+    if(p.castling & 2) s += 'Q';
+    if(p.castling & 4) s += 'k';
+    if(p.castling & 8) s += 'q';
+    s += ' ';
+    if(p.ep < 0) s += '-';
+    else { s += char('a'+file_of(p.ep)); s += char('1'+rank_of(p.ep)); }
+    s += ' ' + std::to_string(p.halfmove) + ' ' + std::to_string(p.fullmove);
+    return s;
+}
+
 // --- Attaques & check ---
 
 inline bool square_attacked(const Position &p,int sq0,Color by){
-    U64 occ=p.occ_all;
+    U64 occ=occupied(p);
     int dir = by==WHITE?1:-1;
     int r=rank_of(sq0), f=file_of(sq0);
     int pr=r-dir;
@@ -291,286 +715,420 @@ inline bool square_attacked(const Position &p,int sq0,Color by){
         if(f>0 && p.board[sq(f-1,pr)]==make_piece(by,PAWN))return true;
         if(f<7 && p.board[sq(f+1,pr)]==make_piece(by,PAWN))return true;
     }
-    if(knight_att[sq0] & p.bb[by][KNIGHT]) return true;
-    if(king_att[sq0]   & p.bb[by][KING])   return true;
-    if(bishop_attacks(sq0,occ) & (p.bb[by][BISHOP]|p.bb[by][QUEEN])) return true;
-    if(rook_attacks(sq0,occ)   & (p.bb[by][ROOK]  |p.bb[by][QUEEN])) return true;
+    if(knight_att[sq0] & pieces(p,by,KNIGHT)) return true;
+    if(king_att[sq0]   & pieces(p,by,KING))   return true;
+    if(bishop_attacks(sq0,occ) & (pieces(p,by,BISHOP)|pieces(p,by,QUEEN))) return true;
+    if(rook_attacks(sq0,occ)   & (pieces(p,by,ROOK)  |pieces(p,by,QUEEN))) return true;
     return false;
 }
 
+// attaquants du camp 'by' sur sq0 pour une occupation donnée
+inline U64 attackers_to(const Position &p,int sq0,Color by,U64 occ){
+    return (pawn_att[by^1][sq0]   & pieces(p,by,PAWN))
+         | (knight_att[sq0]       & pieces(p,by,KNIGHT))
+         | (king_att[sq0]         & pieces(p,by,KING))
+         | (bishop_attacks(sq0,occ) & (pieces(p,by,BISHOP)|pieces(p,by,QUEEN)))
+         | (rook_attacks(sq0,occ)   & (pieces(p,by,ROOK)  |pieces(p,by,QUEEN)));
+}
+
+// --- SEE (static exchange evaluation) ---
+
+static const int SEE_VAL[6] = {100,320,330,500,900,20000};
+
+// gain matériel d'une suite de recaptures sur la case d'arrivée,
+// chaque camp reprenant avec sa pièce la moins chère (rayons X compris)
+inline int see(const Position &p,int m){
+    int from=move_from(m), to=move_to(m);
+    int gain[32];
+    int d=0;
+
+    U64 occ = occupied(p);
+    int victimT;
+    if(m & MF_ENPASSANT){
+        victimT = PAWN;
+        occ ^= bb_one(to + (p.stm==WHITE ? -8 : 8));
+    }else{
+        Piece v = p.board[to];
+        victimT = v ? piece_type(v) : -1;
+    }
+    gain[0] = victimT>=0 ? SEE_VAL[victimT] : 0;
+
+    int attackerT = piece_type(p.board[from]);
+    occ ^= bb_one(from);
+    Color side = (Color)(p.stm^1);
+
+    U64 diag  = p.by_type[BISHOP]|p.by_type[QUEEN];
+    U64 ortho = p.by_type[ROOK]  |p.by_type[QUEEN];
+    U64 att = (attackers_to(p,to,WHITE,occ) | attackers_to(p,to,BLACK,occ)) & occ;
+
+    while(true){
+        U64 mine = att & p.occ[side];
+        if(!mine) break;
+
+        int t;
+        U64 b=0;
+        for(t=PAWN;t<=KING;t++){
+            b = mine & pieces(p,side,t);
+            if(b) break;
+        }
+
+        d++;
+        gain[d] = SEE_VAL[attackerT] - gain[d-1];
+        // élagage : aucun des deux camps ne peut améliorer son résultat
+        if(std::max(-gain[d-1], gain[d]) < 0){ d--; break; }
+        // le roi ne prend pas une case encore défendue
+        if(t==KING && (att & p.occ[side^1] & occ)){ d--; break; }
+
+        occ ^= b & (~b + 1);
+        if(t==PAWN || t==BISHOP || t==QUEEN) att |= bishop_attacks(to,occ) & diag;
+        if(t==ROOK || t==QUEEN)              att |= rook_attacks(to,occ)   & ortho;
+        att &= occ;
+
+        attackerT = t;
+        side = (Color)(side^1);
+        if(d>=31) break;
+    }
+
+    for(;d>0;d--)
+        gain[d-1] = -std::max(-gain[d-1], gain[d]);
+    return gain[0];
+}
+
 inline bool in_check(const Position &p,Color side){
-    U64 kbb=p.bb[side][KING]; if(!kbb) return false;
+    U64 kbb=pieces(p,side,KING); if(!kbb) return false;
     int ks=__builtin_ctzll(kbb);
     return square_attacked(p,ks,(Color)(side^1));
 }
 
-// --- Génération de coups ---
+// mat impossible : rois seuls, ou un seul fou / cavalier en tout
+inline bool insufficient_material(const Position &p){
+    for(int c=0;c<2;c++)
+        if(pieces(p,c,PAWN) | pieces(p,c,ROOK) | pieces(p,c,QUEEN)) return false;
+    int minors = bb_count(p.by_type[KNIGHT] | p.by_type[BISHOP]);
+    return minors <= 1;
+}
 
-inline int generate_moves(const Position &p,int *moves,bool captures_only=false){
-    int n=0;
-    Color us=p.stm, them=(Color)(us^1);
-    U64 own=p.occ[us], opp=p.occ[them], occ=p.occ_all;
-    int pawn_dir   = us==WHITE?1:-1;
-    int start_rank = us==WHITE?1:6;
-    int promo_rank = us==WHITE?6:1;
-    int ep_rank    = us==WHITE?4:3;
-
-    // Pions
-    U64 pawns=p.bb[us][PAWN];
-    while(pawns){
-        int s=pop_lsb(pawns);
-        int r=rank_of(s), f=file_of(s);
-        int fr= r + pawn_dir;
-        if(fr>=0&&fr<8){
-            int forward=sq(f,fr);
-            // Coups calmes / promotions calmes uniquement si !captures_only
-            if(!captures_only){
-                if(!(occ&bb_one(forward))){
-                    if(r==promo_rank){
-                        moves[n++]=make_move_int(s,forward,QUEEN, MF_PROMO);
-                        moves[n++]=make_move_int(s,forward,ROOK,  MF_PROMO);
-                        moves[n++]=make_move_int(s,forward,BISHOP,MF_PROMO);
-                        moves[n++]=make_move_int(s,forward,KNIGHT,MF_PROMO);
-                    }else{
-                        moves[n++]=make_move_int(s,forward);
-                        if(r==start_rank){
-                            int ff=sq(f,fr+pawn_dir);
-                            if(!(occ&bb_one(ff)))
-                                moves[n++]=make_move_int(s,ff);
-                        }
-                    }
-                }
-            }
-            // Captures & EP (toujours générées, y compris en quiescence)
-            for(int df=-1; df<=1; df+=2){
-                int ff=f+df; if(ff<0||ff>7) continue;
-                int to=sq(ff,fr);
-
-                if(opp&bb_one(to)){
-                    // --- FIX: capture + promotion = 4 choix (Q/R/B/N)
-                    if(r==promo_rank){
-                        moves[n++]=make_move_int(s,to,QUEEN,  MF_CAPTURE|MF_PROMO);
-                        moves[n++]=make_move_int(s,to,ROOK,   MF_CAPTURE|MF_PROMO);
-                        moves[n++]=make_move_int(s,to,BISHOP, MF_CAPTURE|MF_PROMO);
-                        moves[n++]=make_move_int(s,to,KNIGHT, MF_CAPTURE|MF_PROMO);
-                    }else{
-                        moves[n++]=make_move_int(s,to,0,MF_CAPTURE);
-                    }
-                }else if(p.ep==to && r==ep_rank){
-                    moves[n++]=make_move_int(s,to,0,MF_CAPTURE|MF_ENPASSANT);
-                }
-            }
-        }
+// --- Génération de coups légaux (masques d'échec et de clouage) ---
+
+// GEN_CAPTURES : captures (promotions-captures et EP incluses)
+// GEN_QUIETS   : tout le reste (poussées, promotions calmes, roques)
+// GEN_EVASIONS : tous les coups, roi en échec (pas de roque)
+enum GenType { GEN_ALL=0, GEN_CAPTURES, GEN_QUIETS, GEN_EVASIONS };
+
+// masques de colonnes et décalages (génération des pions, éval)
+constexpr U64 FILE_A_BB = 0x0101010101010101ULL;
+constexpr U64 FILE_H_BB = 0x8080808080808080ULL;
+
+constexpr U64 shift_east(U64 b){ return (b << 1) & ~FILE_A_BB; }
+constexpr U64 shift_west(U64 b){ return (b >> 1) & ~FILE_H_BB; }
+inline U64 shift_up(U64 b, Color c){ return c==WHITE ? b << 8 : b >> 8; }
+template<Color Us> constexpr U64 shift_up(U64 b){ return Us==WHITE ? b << 8 : b >> 8; }
+
+// constantes d'un camp, résolues à la compilation
+template<Color Us> constexpr Color THEM     = Us==WHITE ? BLACK : WHITE;
+template<Color Us> constexpr int   UP       = Us==WHITE ? 8 : -8;
+template<Color Us> constexpr int   BACK     = Us==WHITE ? 0 : 56;   // a1 / a8
+template<Color Us> constexpr U64   RANK3_BB = Us==WHITE ? 0x0000000000FF0000ULL : 0x0000FF0000000000ULL;
+template<Color Us> constexpr U64   RANK7_BB = Us==WHITE ? 0x00FF000000000000ULL : 0x000000000000FF00ULL;
+template<Color Us> constexpr int   CASTLE_K = Us==WHITE ? 1 : 4;
+template<Color Us> constexpr int   CASTLE_Q = Us==WHITE ? 2 : 8;
+
+template<PieceType Pt> inline U64 piece_attacks(int s,U64 occ){
+    if constexpr(Pt==KNIGHT) return knight_att[s];
+    else if constexpr(Pt==BISHOP) return bishop_attacks(s,occ);
+    else if constexpr(Pt==ROOK) return rook_attacks(s,occ);
+    else return queen_attacks(s,occ);
+}
+
+inline int add_promotions(int *moves,int n,int from,int to,int flags){
+    moves[n++]=make_move_int(from,to,QUEEN, flags);
+    moves[n++]=make_move_int(from,to,ROOK,  flags);
+    moves[n++]=make_move_int(from,to,BISHOP,flags);
+    moves[n++]=make_move_int(from,to,KNIGHT,flags);
+    return n;
+}
+
+// coups de 'from' vers les cases t : prises puis coups calmes
+template<GenType T> inline int add_targets(int *moves,int n,int from,U64 t,U64 opp){
+    if constexpr(T!=GEN_QUIETS)
+        for(U64 c=t&opp; c; ) moves[n++]=make_move_int(from,pop_lsb(c),0,MF_CAPTURE);
+    if constexpr(T!=GEN_CAPTURES)
+        for(U64 q=t&~opp; q; ) moves[n++]=make_move_int(from,pop_lsb(q));
+    return n;
+}
+
+template<Color Us, GenType T, PieceType Pt>
+inline int generate_piece_moves(const Position &p,int *moves,int n,U64 target,U64 pinned,int ksq){
+    U64 opp=p.occ[THEM<Us>], occ=occupied(p);
+    // un cavalier cloué ne bouge jamais
+    U64 bbp = Pt==KNIGHT ? pieces(p,Us,Pt) & ~pinned : pieces(p,Us,Pt);
+    while(bbp){
+        int s=pop_lsb(bbp);
+        U64 t = piece_attacks<Pt>(s,occ) & target;
+        if(Pt!=KNIGHT && (pinned & bb_one(s))) t &= line_bb[ksq][s];
+        n = add_targets<T>(moves,n,s,t,opp);
     }
+    return n;
+}
 
-    // Mode quiescence : on ne génère ensuite que des captures pour les pièces lourdes / roi
-    if(captures_only){
-        // Cavaliers
-        U64 bbp=p.bb[us][KNIGHT];
-        while(bbp){
-            int s=pop_lsb(bbp);
-            U64 t = knight_att[s] & opp;
-            while(t){
-                int to=pop_lsb(t);
-                moves[n++]=make_move_int(s,to,0,MF_CAPTURE);
-            }
-        }
-        // Fous
-        bbp=p.bb[us][BISHOP];
-        while(bbp){
-            int s=pop_lsb(bbp);
-            U64 t = bishop_attacks(s,occ) & opp;
-            while(t){
-                int to=pop_lsb(t);
-                moves[n++]=make_move_int(s,to,0,MF_CAPTURE);
-            }
-        }
-        // Tours
-        bbp=p.bb[us][ROOK];
-        while(bbp){
-            int s=pop_lsb(bbp);
-            U64 t = rook_attacks(s,occ) & opp;
-            while(t){
-                int to=pop_lsb(t);
-                moves[n++]=make_move_int(s,to,0,MF_CAPTURE);
-            }
-        }
-        // Dames
-        bbp=p.bb[us][QUEEN];
-        while(bbp){
-            int s=pop_lsb(bbp);
-            U64 t = queen_attacks(s,occ) & opp;
-            while(t){
-                int to=pop_lsb(t);
-                moves[n++]=make_move_int(s,to,0,MF_CAPTURE);
+// Pions non cloués traités ensemble par décalages ; les cloués, rares,
+// un par un le long de la ligne du roi.
+template<Color Us, GenType T>
+inline int generate_pawn_moves(const Position &p,int *moves,int n,U64 target,U64 pinned,int ksq){
+    constexpr Color Them = THEM<Us>;
+    constexpr int Up = UP<Us>;
+    U64 opp=p.occ[Them], empty=~occupied(p);
+    U64 pawns = pieces(p,Us,PAWN);
+    U64 free  = pawns & ~pinned;
+    U64 low   = free & ~RANK7_BB<Us>, high = free & RANK7_BB<Us>;
+
+    if constexpr(T!=GEN_CAPTURES){
+        U64 one = shift_up<Us>(low) & empty;
+        U64 two = shift_up<Us>(one & RANK3_BB<Us>) & empty & target;
+        one &= target;
+        while(one){ int to=pop_lsb(one); moves[n++]=make_move_int(to-Up,to); }
+        while(two){ int to=pop_lsb(two); moves[n++]=make_move_int(to-2*Up,to); }
+        U64 promo = shift_up<Us>(high) & empty & target;
+        while(promo){ int to=pop_lsb(promo); n=add_promotions(moves,n,to-Up,to,MF_PROMO); }
+    }
+    if constexpr(T!=GEN_QUIETS){
+        U64 east = shift_east(shift_up<Us>(low)) & opp & target;
+        U64 west = shift_west(shift_up<Us>(low)) & opp & target;
+        while(east){ int to=pop_lsb(east); moves[n++]=make_move_int(to-Up-1,to,0,MF_CAPTURE); }
+        while(west){ int to=pop_lsb(west); moves[n++]=make_move_int(to-Up+1,to,0,MF_CAPTURE); }
+        east = shift_east(shift_up<Us>(high)) & opp & target;
+        west = shift_west(shift_up<Us>(high)) & opp & target;
+        while(east){ int to=pop_lsb(east); n=add_promotions(moves,n,to-Up-1,to,MF_CAPTURE|MF_PROMO); }
+        while(west){ int to=pop_lsb(west); n=add_promotions(moves,n,to-Up+1,to,MF_CAPTURE|MF_PROMO); }
+    }
+
+    for(U64 pin = pawns & pinned; pin; ){
+        int s=pop_lsb(pin);
+        U64 allowed = target & line_bb[ksq][s];
+        bool promo = RANK7_BB<Us> & bb_one(s);
+        if constexpr(T!=GEN_CAPTURES){
+            U64 one = shift_up<Us>(bb_one(s)) & empty;
+            U64 two = shift_up<Us>(one & RANK3_BB<Us>) & empty & allowed;
+            if(one & allowed){
+                if(promo) n=add_promotions(moves,n,s,s+Up,MF_PROMO);
+                else      moves[n++]=make_move_int(s,s+Up);
             }
+            if(two) moves[n++]=make_move_int(s,s+2*Up);
         }
-        // Roi (captures seulement, pas de roques)
-        bbp=p.bb[us][KING];
-        if(bbp){
-            int s=pop_lsb(bbp);
-            U64 t = king_att[s] & opp;
-            while(t){
-                int to=pop_lsb(t);
-                moves[n++]=make_move_int(s,to,0,MF_CAPTURE);
+        if constexpr(T!=GEN_QUIETS){
+            for(U64 caps = pawn_att[Us][s] & opp & allowed; caps; ){
+                int to=pop_lsb(caps);
+                if(promo) n=add_promotions(moves,n,s,to,MF_CAPTURE|MF_PROMO);
+                else      moves[n++]=make_move_int(s,to,0,MF_CAPTURE);
             }
         }
-        return n;
     }
 
-    // Cavaliers (tous coups)
-    {
-        U64 bbp=p.bb[us][KNIGHT];
-        while(bbp){
-            int s=pop_lsb(bbp);
-            U64 t=knight_att[s] & ~own;
-            while(t){
-                int to=pop_lsb(t);
-                int flags=(opp&bb_one(to))?MF_CAPTURE:0;
-                moves[n++]=make_move_int(s,to,0,flags);
+    // EP : on vérifie directement le roi avec les deux pions retirés
+    if constexpr(T!=GEN_QUIETS){
+        if(p.ep!=-1){
+            int cap_sq = p.ep - Up;
+            for(U64 eps = pawn_att[Them][p.ep] & pawns; eps; ){
+                int s=pop_lsb(eps);
+                U64 occEp = (occupied(p) ^ bb_one(s) ^ bb_one(cap_sq)) | bb_one(p.ep);
+                if(!(attackers_to(p,ksq,Them,occEp) & ~bb_one(cap_sq)))
+                    moves[n++]=make_move_int(s,p.ep,0,MF_CAPTURE|MF_ENPASSANT);
             }
         }
     }
-    // Fous
-    {
-        U64 bbp=p.bb[us][BISHOP];
-        while(bbp){
-            int s=pop_lsb(bbp);
-            U64 t=bishop_attacks(s,occ) & ~own;
-            while(t){
-                int to=pop_lsb(t);
-                int flags=(opp&bb_one(to))?MF_CAPTURE:0;
-                moves[n++]=make_move_int(s,to,0,flags);
-            }
-        }
+    return n;
+}
+
+template<Color Us, GenType T>
+inline int generate_legal_moves(const Position &p,int *moves){
+    constexpr Color Them = THEM<Us>;
+    int n=0;
+    U64 own=p.occ[Us], opp=p.occ[Them], occ=occupied(p);
+    int ksq=__builtin_ctzll(pieces(p,Us,KING));
+
+    U64 checkers = attackers_to(p,ksq,Them,occ);
+
+    // pièces clouées : un seul bloqueur (à nous) entre le roi et un sniper adverse
+    U64 pinned = 0;
+    U64 snipers = (rook_attacks(ksq,opp)   & (pieces(p,Them,ROOK)  |pieces(p,Them,QUEEN)))
+                | (bishop_attacks(ksq,opp) & (pieces(p,Them,BISHOP)|pieces(p,Them,QUEEN)));
+    while(snipers){
+        int s=pop_lsb(snipers);
+        U64 b=between_bb[ksq][s] & occ;
+        if(b && !(b&(b-1)) && (b&own)) pinned |= b;
     }
-    // Tours
-    {
-        U64 bbp=p.bb[us][ROOK];
-        while(bbp){
-            int s=pop_lsb(bbp);
-            U64 t=rook_attacks(s,occ) & ~own;
-            while(t){
-                int to=pop_lsb(t);
-                int flags=(opp&bb_one(to))?MF_CAPTURE:0;
-                moves[n++]=make_move_int(s,to,0,flags);
-            }
-        }
+
+    // cases d'arrivée selon le type ; les autres pièces que le roi doivent
+    // en plus parer l'échec (aucune en double échec)
+    const U64 kingTarget = T==GEN_CAPTURES ? opp : T==GEN_QUIETS ? ~occ : ~own;
+    U64 target = kingTarget;
+    if(checkers & (checkers-1)){
+        target = 0;
+    }else if(checkers){
+        int c=__builtin_ctzll(checkers);
+        target &= between_bb[ksq][c] | checkers;
+    }
+
+    if(target){
+        n = generate_pawn_moves<Us,T>(p,moves,n,target,pinned,ksq);
+        n = generate_piece_moves<Us,T,KNIGHT>(p,moves,n,target,pinned,ksq);
+        n = generate_piece_moves<Us,T,BISHOP>(p,moves,n,target,pinned,ksq);
+        n = generate_piece_moves<Us,T,ROOK>  (p,moves,n,target,pinned,ksq);
+        n = generate_piece_moves<Us,T,QUEEN> (p,moves,n,target,pinned,ksq);
     }
-    // Dames
+
+    // Roi : la case d'arrivée ne doit pas être attaquée une fois le roi retiré
     {
-        U64 bbp=p.bb[us][QUEEN];
-        while(bbp){
-            int s=pop_lsb(bbp);
-            U64 t=queen_attacks(s,occ) & ~own;
-            while(t){
-                int to=pop_lsb(t);
-                int flags=(opp&bb_one(to))?MF_CAPTURE:0;
-                moves[n++]=make_move_int(s,to,0,flags);
-            }
+        U64 t = king_att[ksq] & kingTarget, safe = 0;
+        U64 occNoKing = occ ^ bb_one(ksq);
+        while(t){
+            int to=pop_lsb(t);
+            if(!attackers_to(p,to,Them,occNoKing)) safe |= bb_one(to);
         }
+        n = add_targets<T>(moves,n,ksq,safe,opp);
     }
 
-    // Roi + roques
-    {
-        U64 bbp=p.bb[us][KING];
-        if(bbp){
-            int s=pop_lsb(bbp);
-            U64 t=king_att[s] & ~own;
-            while(t){
-                int to=pop_lsb(t);
-                int flags=(opp&bb_one(to))?MF_CAPTURE:0;
-                moves[n++]=make_move_int(s,to,0,flags);
-            }
-            Color themC = them;
-            if(us==WHITE){
-                if(p.castling&1){
-                    if(!p.board[sq(5,0)] && !p.board[sq(6,0)] &&
-                       !square_attacked(p,s,themC) &&
-                       !square_attacked(p,sq(5,0),themC) &&
-                       !square_attacked(p,sq(6,0),themC))
-                        moves[n++]=make_move_int(s,sq(6,0),0,MF_KSCASTLE);
-                }
-                if(p.castling&2){
-                    if(!p.board[sq(1,0)] && !p.board[sq(2,0)] && !p.board[sq(3,0)] &&
-                       !square_attacked(p,s,themC) &&
-                       !square_attacked(p,sq(2,0),themC) &&
-                       !square_attacked(p,sq(3,0),themC))
-                        moves[n++]=make_move_int(s,sq(2,0),0,MF_QSCASTLE);
-                }
-            }else{
-                if(p.castling&4){
-                    if(!p.board[sq(5,7)] && !p.board[sq(6,7)] &&
-                       !square_attacked(p,s,themC) &&
-                       !square_attacked(p,sq(5,7),themC) &&
-                       !square_attacked(p,sq(6,7),themC))
-                        moves[n++]=make_move_int(s,sq(6,7),0,MF_KSCASTLE);
-                }
-                if(p.castling&8){
-                    if(!p.board[sq(1,7)] && !p.board[sq(2,7)] && !p.board[sq(3,7)] &&
-                       !square_attacked(p,s,themC) &&
-                       !square_attacked(p,sq(2,7),themC) &&
-                       !square_attacked(p,sq(3,7),themC))
-                        moves[n++]=make_move_int(s,sq(2,7),0,MF_QSCASTLE);
-                }
-            }
+    // Roques (jamais en échec, cases de passage non attaquées)
+    if constexpr(T==GEN_ALL || T==GEN_QUIETS){
+        constexpr int b = BACK<Us>;
+        if(!checkers){
+            if((p.castling&CASTLE_K<Us>) &&
+               !(occ & (bb_one(b+5)|bb_one(b+6))) &&
+               !square_attacked(p,b+5,Them) &&
+               !square_attacked(p,b+6,Them))
+                moves[n++]=make_move_int(ksq,b+6,0,MF_KSCASTLE);
+            if((p.castling&CASTLE_Q<Us>) &&
+               !(occ & (bb_one(b+1)|bb_one(b+2)|bb_one(b+3))) &&
+               !square_attacked(p,b+2,Them) &&
+               !square_attacked(p,b+3,Them))
+                moves[n++]=make_move_int(ksq,b+2,0,MF_QSCASTLE);
         }
     }
     return n;
 }
 
+template<Color Us>
+inline int generate_legal_dispatch(const Position &p,int *moves,GenType type){
+    switch(type){
+    case GEN_CAPTURES: return generate_legal_moves<Us,GEN_CAPTURES>(p,moves);
+    case GEN_QUIETS:   return generate_legal_moves<Us,GEN_QUIETS>(p,moves);
+    case GEN_EVASIONS: return generate_legal_moves<Us,GEN_EVASIONS>(p,moves);
+    default:           return generate_legal_moves<Us,GEN_ALL>(p,moves);
+    }
+}
+
+inline int generate_legal_moves(const Position &p,int *moves,GenType type=GEN_ALL){
+    PROF_SCOPE(PROF_MOVEGEN);
+    return p.stm==WHITE ? generate_legal_dispatch<WHITE>(p,moves,type)
+                        : generate_legal_dispatch<BLACK>(p,moves,type);
+}
+
+// Validation d'un coup venant d'ailleurs (TT, killers) sans générer toute la liste.
+inline bool move_is_legal(const Position &p,int m){
+    if(!m || (m & ~0x1F007FFF)) return false;
+    if(!(m & MF_PROMO) && move_promo(m)) return false;
+    Color us=p.stm, them=(Color)(us^1);
+    int from=move_from(m), to=move_to(m);
+    Piece pc=p.board[from];
+    if(pc==EMPTY || piece_color(pc)!=us) return false;
+    if(p.occ[us] & bb_one(to)) return false;
+    int t=piece_type(pc);
+    U64 occ=occupied(p);
+
+    // roques : rares, on passe par le générateur
+    if(m & (MF_KSCASTLE|MF_QSCASTLE)){
+        if(t!=KING) return false;
+        int moves[256];
+        int n=generate_legal_moves(p,moves,GEN_QUIETS);
+        for(int i=0;i<n;i++) if(moves[i]==m) return true;
+        return false;
+    }
+
+    int cap_sq = to;
+    if(m & MF_ENPASSANT){
+        if(t!=PAWN || to!=p.ep || !(pawn_att[us][from] & bb_one(to))) return false;
+        if((m & MF_PROMO) || !(m & MF_CAPTURE)) return false; // le générateur pose toujours les deux
+        cap_sq = to + (us==WHITE ? -8 : 8);
+    }else{
+        if(bool(m & MF_CAPTURE) != bool(p.occ[them] & bb_one(to))) return false;
+        if(t==PAWN){
+            bool promoRank = rank_of(to)==(us==WHITE?7:0);
+            if(promoRank != bool(m & MF_PROMO)) return false;
+            if(promoRank && (move_promo(m)<KNIGHT || move_promo(m)>QUEEN)) return false;
+            int dir = us==WHITE ? 8 : -8;
+            if(m & MF_CAPTURE){
+                if(!(pawn_att[us][from] & bb_one(to))) return false;
+            }else if(to==from+dir){
+                if(occ & bb_one(to)) return false;
+            }else if(to==from+2*dir && rank_of(from)==(us==WHITE?1:6)){
+                if(occ & (bb_one(from+dir)|bb_one(to))) return false;
+            }else return false;
+        }else{
+            if(m & MF_PROMO) return false;
+            U64 att = t==KNIGHT ? knight_att[from]
+                    : t==BISHOP ? bishop_attacks(from,occ)
+                    : t==ROOK   ? rook_attacks(from,occ)
+                    : t==QUEEN  ? queen_attacks(from,occ)
+                                : king_att[from];
+            if(!(att & bb_one(to))) return false;
+        }
+    }
+
+    // le roi ne doit pas rester attaqué (pièce prise exclue)
+    U64 occ2 = ((occ ^ bb_one(from)) & ~bb_one(cap_sq)) | bb_one(to);
+    int ksq = t==KING ? to : __builtin_ctzll(pieces(p,us,KING));
+    return !(attackers_to(p,ksq,them,occ2) & ~bb_one(cap_sq) & ~bb_one(to));
+}
+
 // --- make / unmake ---
 
-inline void make_move(Position &p,int m,Undo &u){
-    u.prev = p; // snapshot avant modifs
+// droits de roque conservés quand une pièce quitte ou atteint la case
+// (roi en e1/e8, tours en a1 h1 a8 h8) : castling &= KEEP[from] & KEEP[to]
+constexpr int CASTLE_KEEP[64] = {
+    13,15,15,15,12,15,15,14,
+    15,15,15,15,15,15,15,15,
+    15,15,15,15,15,15,15,15,
+    15,15,15,15,15,15,15,15,
+    15,15,15,15,15,15,15,15,
+    15,15,15,15,15,15,15,15,
+    15,15,15,15,15,15,15,15,
+     7,15,15,15, 3,15,15,11,
+};
 
+template<Color Us>
+inline void make_move(Position &p,int m,Undo &u){
     int from=move_from(m), to=move_to(m);
     Piece pc=p.board[from];
     Piece captured=p.board[to];
 
+    u.castling = p.castling;
+    u.ep       = p.ep;
+    u.halfmove = p.halfmove;
+    u.key      = p.key;
+
     // retirer EP hash
     if(p.ep != -1){
         p.key ^= zob_ep[file_of(p.ep)];
     }
     p.ep = -1;
 
-    int oldCastling = p.castling;
-
     // EP
     if(m & MF_ENPASSANT){
-        int cap_sq = to + (p.stm==WHITE ? -8 : 8);
+        int cap_sq = to - UP<Us>;
         captured = p.board[cap_sq];
         remove_piece(p, cap_sq);
     }
 
-    // droits de roque (roi)
-    if(piece_type(pc)==KING){
-        if(p.stm==WHITE) p.castling &= ~3;
-        else             p.castling &= ~12;
-    }
-
-    // droits de roque (tours qui bougent)
-    if(piece_type(pc)==ROOK){
-        if(from==sq(0,0))p.castling&=~2;
-        if(from==sq(7,0))p.castling&=~1;
-        if(from==sq(0,7))p.castling&=~8;
-        if(from==sq(7,7))p.castling&=~4;
-    }
-    // droits de roque (tours capturées)
-    if(captured==W_ROOK){
-        if(to==sq(0,0))p.castling&=~2;
-        if(to==sq(7,0))p.castling&=~1;
-    }else if(captured==B_ROOK){
-        if(to==sq(0,7))p.castling&=~8;
-        if(to==sq(7,7))p.castling&=~4;
-    }
-
-    // MAJ zobrist castling
+    // droits de roque (roi ou tour qui bouge, tour capturée)
+    int oldCastling = p.castling;
+    p.castling &= CASTLE_KEEP[from] & CASTLE_KEEP[to];
     if(oldCastling != p.castling){
         p.key ^= zob_castle[oldCastling & 15];
         p.key ^= zob_castle[p.castling & 15];
     }
 
+    u.captured = captured;
+
     // captures normales
     if(!(m & MF_ENPASSANT) && captured!=EMPTY){
         remove_piece(p, to);
@@ -579,52 +1137,73 @@ inline void make_move(Position &p,int m,Undo &u){
     // promotion ou déplacement
     if(m & MF_PROMO){
         remove_piece(p, from);
-        PieceType pt=(PieceType)move_promo(m);
-        Piece new_pc=make_piece(p.stm,pt);
-        add_piece(p, to, new_pc);
+        add_piece(p, to, make_piece(Us,(PieceType)move_promo(m)));
     }else{
         move_piece(p, from, to);
     }
 
     // roque : déplacement tour
-    if(piece_type(pc)==KING){
-        if(m & MF_KSCASTLE){
-            if(p.stm==WHITE){
-                move_piece(p, sq(7,0), sq(5,0));
-            }else{
-                move_piece(p, sq(7,7), sq(5,7));
-            }
-        }else if(m & MF_QSCASTLE){
-            if(p.stm==WHITE){
-                move_piece(p, sq(0,0), sq(3,0));
-            }else{
-                move_piece(p, sq(0,7), sq(3,7));
-            }
-        }
-    }
+    if(m & MF_KSCASTLE)      move_piece(p, BACK<Us>+7, BACK<Us>+5);
+    else if(m & MF_QSCASTLE) move_piece(p, BACK<Us>,   BACK<Us>+3);
 
     // double push -> EP
-    if(piece_type(pc)==PAWN){
-        int from_r=rank_of(from), to_r=rank_of(to);
-        if((p.stm==WHITE && from_r==1 && to_r==3) ||
-           (p.stm==BLACK && from_r==6 && to_r==4)){
-            p.ep = (from+to)/2;
-            p.key ^= zob_ep[file_of(p.ep)];
-        }
+    if(piece_type(pc)==PAWN && to-from==2*UP<Us>){
+        p.ep = (from+to)/2;
+        p.key ^= zob_ep[file_of(p.ep)];
     }
 
     // clocks
     if(piece_type(pc)==PAWN || captured!=EMPTY) p.halfmove=0;
     else p.halfmove++;
-    if(p.stm==BLACK) p.fullmove++;
+    if constexpr(Us==BLACK) p.fullmove++;
 
     // side to move
-    p.stm = (Color)(p.stm^1);
+    p.stm = THEM<Us>;
     p.key ^= zob_side;
 }
 
-inline void unmake_move(Position &p,const Undo &u){
-    p = u.prev;
+// Us : camp qui a joué m
+template<Color Us>
+inline void unmake_move(Position &p,int m,const Undo &u){
+    p.stm = Us;
+    if constexpr(Us==BLACK) p.fullmove--;
+
+    int from=move_from(m), to=move_to(m);
+
+    // roque : tour remise en place
+    if(m & MF_KSCASTLE)      move_piece(p, BACK<Us>+5, BACK<Us>+7);
+    else if(m & MF_QSCASTLE) move_piece(p, BACK<Us>+3, BACK<Us>);
+
+    // promotion ou déplacement
+    if(m & MF_PROMO){
+        remove_piece(p, to);
+        add_piece(p, from, make_piece(Us,PAWN));
+    }else{
+        move_piece(p, to, from);
+    }
+
+    // pièce capturée
+    if(u.captured!=EMPTY){
+        int cap_sq = (m & MF_ENPASSANT) ? to - UP<Us> : to;
+        add_piece(p, cap_sq, u.captured);
+    }
+
+    p.castling = u.castling;
+    p.ep       = u.ep;
+    p.halfmove = u.halfmove;
+    p.key      = u.key;
+}
+
+inline void make_move(Position &p,int m,Undo &u){
+    PROF_SCOPE(PROF_MAKE);
+    if(p.stm==WHITE) make_move<WHITE>(p,m,u);
+    else             make_move<BLACK>(p,m,u);
+}
+
+inline void unmake_move(Position &p,int m,const Undo &u){
+    PROF_SCOPE(PROF_UNMAKE);
+    if(p.stm==BLACK) unmake_move<WHITE>(p,m,u);
+    else             unmake_move<BLACK>(p,m,u);
 }
 
 // --- Interface partie (historique global) ---
@@ -646,443 +1225,619 @@ inline void apply_game_move(Position &p, int m){
 
 // --- PST & évaluation ---
 
-// PST MG
-static const int PST_MG[6][64] = {
-// PAWN
-{
-  0,  0,  0,  0,  0,  0,  0,  0,
- 50, 50, 50, 50, 50, 50, 50, 50,
- 10, 10, 20, 30, 30, 20, 10, 10,
-  5,  5, 10, 27, 27, 10,  5,  5,
-  0,  0,  0, 25, 25,  0,  0,  0,
-  5, -5,-10,  0,  0,-10, -5,  5,
-  5, 10, 10,-25,-25, 10, 10,  5,
-  0,  0,  0,  0,  0,  0,  0,  0
-},
-// KNIGHT
-{
--50,-40,-30,-30,-30,-30,-40,-50,
--40,-20,  0,  5,  5,  0,-20,-40,
--30,  5, 10, 15, 15, 10,  5,-30,
--30,  0, 15, 20, 20, 15,  0,-30,
--30,  5, 15, 20, 20, 15,  5,-30,
--30,  0, 10, 15, 15, 10,  0,-30,
--40,-20,  0,  0,  0,  0,-20,-40,
--50,-40,-30,-30,-30,-30,-40,-50
-},
-// BISHOP
-{
--20,-10,-10,-10,-10,-10,-10,-20,
--10,  5,  0,  0,  0,  0,  5,-10,
--10, 10, 10, 10, 10, 10, 10,-10,
--10,  0, 10, 10, 10, 10,  0,-10,
--10,  5,  5, 10, 10,  5,  5,-10,
--10,  0,  5, 10, 10,  5,  0,-10,
--10,  0,  0,  0,  0,  0,  0,-10,
--20,-10,-10,-10,-10,-10,-10,-20
-},
-// ROOK
-{
-  0,  0,  5, 10, 10,  5,  0,  0,
- -5,  0,  0,  0,  0,  0,  0, -5,
- -5,  0,  0,  0,  0,  0,  0, -5,
- -5,  0,  0,  0,  0,  0,  0, -5,
- -5,  0,  0,  0,  0,  0,  0, -5,
- -5,  0,  0,  0,  0,  0,  0, -5,
-  5, 10, 10, 10, 10, 10, 10,  5,
-  0,  0,  0,  0,  0,  0,  0,  0
-},
-// QUEEN
-{
--20,-10,-10, -5, -5,-10,-10,-20,
--10,  0,  5,  0,  0,  0,  0,-10,
--10,  5,  5,  5,  5,  5,  0,-10,
- -5,  0,  5,  5,  5,  5,  0, -5,
-  0,  0,  5,  5,  5,  5,  0, -5,
--10,  0,  5,  5,  5,  5,  0,-10,
--10,  0,  0,  0,  0,  0,  0,-10,
--20,-10,-10, -5, -5,-10,-10,-20
-},
-// KING MG
-{
--30,-40,-40,-50,-50,-40,-40,-30,
--30,-40,-40,-50,-50,-40,-40,-30,
--30,-40,-40,-50,-50,-40,-40,-30,
--30,-40,-40,-50,-50,-40,-40,-30,
--20,-30,-30,-40,-40,-30,-30,-20,
--10,-20,-20,-20,-20,-20,-20,-10,
- 20, 20,  0,  0,  0,  0, 20, 20,
- 20, 30, 10,  0,  0, 10, 30, 20
+// masques constants de l'éval (bit = rang*8 + colonne)
+constexpr U64 CENTER_BB = 0x0000001818000000ULL;                 // d4 e4 d5 e5
+constexpr U64 KNIGHT_START_BB[2] = {0x0000000000000042ULL, 0x4200000000000000ULL};
+constexpr U64 BISHOP_START_BB[2] = {0x0000000000000024ULL, 0x2400000000000000ULL};
+constexpr U64 CASTLED_KING_BB[2] = {0x0000000000000044ULL, 0x4400000000000000ULL}; // c1 g1 / c8 g8
+constexpr U64 KING_START_BB      = 0x1000000000000010ULL;          // e1 ou e8, quel que soit le camp
+
+// décalages et remplissages : travail sur tous les pions d'un coup
+inline U64 north_fill(U64 b){ b |= b << 8; b |= b << 16; b |= b << 32; return b; }
+inline U64 south_fill(U64 b){ b |= b >> 8; b |= b >> 16; b |= b >> 32; return b; }
+inline U64 file_fill(U64 b){ return north_fill(b) | south_fill(b); }
+// cases devant (strictement) les pièces de b, vues par c
+inline U64 front_span(U64 b, Color c){ return c==WHITE ? north_fill(b << 8) : south_fill(b >> 8); }
+// cases attaquées par les pions 'b' du camp c
+inline U64 pawn_attacks_bb(U64 b, Color c){
+    U64 f = shift_up(b, c);
+    return shift_east(f) | shift_west(f);
 }
+
+// Chaque terme passe par un accumulateur : EvalScore y ajoute les poids
+// d'EVAL_W, le tuner (tuner.cpp) y relève le nombre d'occurrences.
+struct EvalScore {
+    int mg = 0, eg = 0;
+    void add(int term, int n){ mg += EVAL_W[term][0]*n; eg += EVAL_W[term][1]*n; }
 };
 
-// PST EG
-static const int PST_EG[6][64] = {
-// PAWN
-{
-  0,  0,  0,  0,  0,  0,  0,  0,
- 10, 10, 10, 10, 10, 10, 10, 10,
-  0,  0,  5, 10, 10,  5,  0,  0,
-  0,  0, 10, 20, 20, 10,  0,  0,
-  0,  0, 10, 25, 25, 10,  0,  0,
-  0,  0,  5, 10, 10,  5,  0,  0,
-  0,  0,  0,-10,-10,  0,  0,  0,
-  0,  0,  0,  0,  0,  0,  0,  0
-},
-// KNIGHT
-{
--40,-30,-20,-20,-20,-20,-30,-40,
--30,-10,  0,  0,  0,  0,-10,-30,
--20,  0, 10, 15, 15, 10,  0,-20,
--20,  5, 15, 20, 20, 15,  5,-20,
--20,  0, 15, 20, 20, 15,  0,-20,
--20,  5, 10, 15, 15, 10,  5,-20,
--30,-10,  0,  0,  0,  0,-10,-30,
--40,-30,-20,-20,-20,-20,-30,-40
-},
-// BISHOP
-{
--20,-10,-10,-10,-10,-10,-10,-20,
--10,  0,  0,  0,  0,  0,  0,-10,
--10,  0,  5, 10, 10,  5,  0,-10,
--10,  5, 10, 15, 15, 10,  5,-10,
--10,  0, 10, 15, 15, 10,  0,-10,
--10,  5,  5, 10, 10,  5,  5,-10,
--10,  0,  0,  0,  0,  0,  0,-10,
--20,-10,-10,-10,-10,-10,-10,-20
-},
-// ROOK
-{
-  0,  0,  5, 15, 15,  5,  0,  0,
- -5,  0,  0,  5,  5,  0,  0, -5,
- -5,  0,  0,  5,  5,  0,  0, -5,
- -5,  0,  0,  5,  5,  0,  0, -5,
- -5,  0,  0,  5,  5,  0,  0, -5,
- -5,  0,  0,  5,  5,  0,  0, -5,
-  5, 10, 10, 15, 15, 10, 10,  5,
-  0,  0,  0,  5,  5,  0,  0,  0
-},
-// QUEEN
-{
--10,-10,-10, -5, -5,-10,-10,-10,
--10,  0,  0,  0,  0,  0,  0,-10,
--10,  0,  5,  5,  5,  5,  0,-10,
- -5,  0,  5,  5,  5,  5,  0, -5,
-  0,  0,  5,  5,  5,  5,  0, -5,
--10,  0,  5,  5,  5,  5,  0,-10,
--10,  0,  0,  0,  0,  0,  0,-10,
--10,-10,-10, -5, -5,-10,-10,-10
-},
-// KING EG
-{
--50,-40,-30,-20,-20,-30,-40,-50,
--30,-20,-10,  0,  0,-10,-20,-30,
--30,-10, 20, 30, 30, 20,-10,-30,
--30,-10, 30, 40, 40, 30,-10,-30,
--30,-10, 30, 40, 40, 30,-10,-30,
--30,-10, 20, 30, 30, 20,-10,-30,
--30,-30,  0,  0,  0,  0,-30,-30,
--50,-40,-30,-20,-20,-30,-40,-50
+// structure de pions d'un camp : ne dépend que des pions -> mise en cache
+template<class Acc>
+inline void eval_pawns(const Position &p, Color c, Acc &acc, U64 &passed){
+    U64 pawns = pieces(p,c,PAWN);
+    U64 enemy = pieces(p,c^1,PAWN);
+
+    // centre
+    acc.add(PAWN_CENTER, bb_count(pawns & CENTER_BB));
+
+    // doublés : un autre pion du camp sur la même colonne
+    acc.add(PAWN_DOUBLED, bb_count(pawns & (north_fill(pawns << 8) | south_fill(pawns >> 8))));
+
+    // isolés : aucune colonne voisine occupée
+    U64 files = file_fill(pawns);
+    U64 neighbours = shift_east(files) | shift_west(files);
+    U64 isolated = pawns & ~neighbours;
+    acc.add(PAWN_ISOLATED, bb_count(isolated));
+
+    // arriérés (simple) : pion adverse devant et aucun pion voisin à hauteur ou derrière
+    U64 blocked = pawns & front_span(enemy, (Color)(c^1));
+    U64 behind = c==WHITE ? north_fill(pawns) : south_fill(pawns);
+    U64 support = shift_east(behind) | shift_west(behind);
+    acc.add(PAWN_BACKWARD, bb_count(blocked & ~isolated & ~support));
+
+    // passés (au sens de ce moteur : pas de pion adverse devant sur la colonne)
+    passed = pawns & ~blocked;
+    for(U64 b = passed; b; ){
+        int s = pop_lsb(b);
+        int r = (c==WHITE ? rank_of(s) : 7-rank_of(s));
+        acc.add(PASSED_RANK_1 + r, 1);
+    }
+    acc.add(PASSED_PROTECTED, bb_count(passed & pawn_attacks_bb(pawns, c))); // protégés par pion
+    acc.add(PASSED_CONNECTED, bb_count(passed & neighbours));                 // connectés
 }
+
+// --- Table de hachage des pions (une par thread) ---
+
+struct PawnEntry {
+    U64 key = 0;
+    U64 passed[2]{};      // pions passés par camp
+    int mg[2]{}, eg[2]{}; // termes de structure par camp
 };
 
-// petits helpers éval
-inline int is_center_sq(int s){
-    int f=file_of(s), r=rank_of(s);
-    return ( (f==3||f==4) && (r==3||r==4) );
-}
-inline bool is_knight_start(Color c,int s){
-    return (c==WHITE && (s==sq(1,0)||s==sq(6,0))) ||
-           (c==BLACK && (s==sq(1,7)||s==sq(6,7)));
-}
-inline bool is_bishop_start(Color c,int s){
-    return (c==WHITE && (s==sq(2,0)||s==sq(5,0))) ||
-           (c==BLACK && (s==sq(2,7)||s==sq(5,7)));
-}
-inline bool is_king_castled(Color c,int s){
-    return (c==WHITE && (s==sq(6,0)||s==sq(2,0))) ||
-           (c==BLACK && (s==sq(6,7)||s==sq(2,7)));
+constexpr int PAWN_TABLE_SIZE = 1<<14; // 16K entrées, ~768 Ko
+
+struct PawnTable {
+    PawnEntry e[PAWN_TABLE_SIZE];
+};
+
+inline const PawnEntry &probe_pawns(const Position &p, PawnEntry &tmp, PawnTable *pt){
+    PawnEntry &e = pt ? pt->e[p.pawn_key & (PAWN_TABLE_SIZE-1)] : tmp;
+    if(pt && e.key == p.pawn_key) return e;
+    for(int c=0;c<2;c++){
+        EvalScore s;
+        eval_pawns(p,(Color)c,s,e.passed[c]);
+        e.mg[c] = s.mg; e.eg[c] = s.eg;
+    }
+    e.key = p.pawn_key;
+    return e;
 }
 
-// éval d'un camp
-inline int eval_side(const Position &p, Color c, int phase, const int pawnFileCount[2][8]){
-    int mg=0,eg=0;
+// pièces et roi d'un camp (matériel, PST et pions à part)
+template<class Acc>
+inline void eval_pieces(const Position &p, Color c, int phase, Acc &acc){
     U64 own_occ = p.occ[c];
-    U64 all_occ = p.occ_all;
+    U64 all_occ = occupied(p);
+    U64 minors = pieces(p,c,KNIGHT) | pieces(p,c,BISHOP);
+
+    // centre (pions : voir eval_pawns)
+    acc.add(MINOR_CENTER, bb_count(minors & CENTER_BB));
+    acc.add(QUEEN_CENTER, bb_count(pieces(p,c,QUEEN) & CENTER_BB));
+
+    // développement
+    if(phase > 12)
+        acc.add(MINOR_UNDEVELOPED, bb_count((pieces(p,c,KNIGHT) & KNIGHT_START_BB[c]) | (pieces(p,c,BISHOP) & BISHOP_START_BB[c])));
+
+    // mobilité
+    for(U64 b = pieces(p,c,KNIGHT); b; )
+        acc.add(MOB_KNIGHT, bb_count(knight_att[pop_lsb(b)] & ~own_occ));
+    for(U64 b = pieces(p,c,BISHOP); b; )
+        acc.add(MOB_BISHOP, bb_count(bishop_attacks(pop_lsb(b),all_occ) & ~own_occ));
+    for(U64 b = pieces(p,c,ROOK); b; )
+        acc.add(MOB_ROOK, bb_count(rook_attacks(pop_lsb(b),all_occ) & ~own_occ));
+    for(U64 b = pieces(p,c,QUEEN); b; )
+        acc.add(MOB_QUEEN, bb_count(queen_attacks(pop_lsb(b),all_occ) & ~own_occ));
+
+    // tours : colonnes ouvertes / semi-ouvertes
+    U64 myFiles  = file_fill(pieces(p,c,PAWN));
+    U64 oppFiles = file_fill(pieces(p,c^1,PAWN));
+    acc.add(ROOK_OPEN_FILE, bb_count(pieces(p,c,ROOK) & ~myFiles & ~oppFiles));
+    acc.add(ROOK_SEMI_OPEN, bb_count(pieces(p,c,ROOK) & ~myFiles & oppFiles));
 
-    const int *myPawns  = pawnFileCount[c];
-    const int *oppPawns = pawnFileCount[c^1];
+    // sécurité roi
+    U64 kbb = pieces(p,c,KING);
+    if(kbb){
+        int ks = __builtin_ctzll(kbb);
+        int r = (c==WHITE? rank_of(ks): 7-rank_of(ks));
+        if(kbb & CASTLED_KING_BB[c]) acc.add(KING_CASTLED, 1);
+        else if(phase > 12 && (kbb & KING_START_BB)) acc.add(KING_UNCASTLED, 1);
 
-    for(int s=0;s<64;s++){
-        Piece pc = p.board[s];
-        if(pc==EMPTY) continue;
-        if(piece_color(pc)!=c) continue;
-        PieceType t = (PieceType)piece_type(pc);
-        int idx = (c==WHITE ? s : 63-s);
-
-        int v = VAL[t];
-        mg += v + PST_MG[t][idx];
-        eg += v + PST_EG[t][idx];
-
-        // centre
-        if(is_center_sq(s)){
-            if(t==PAWN) { mg += 10; eg += 5; }
-            else if(t==KNIGHT || t==BISHOP){ mg += 8; eg += 5; }
-            else if(t==QUEEN){ mg += 4; }
-        }
+        // bouclier de pions : les trois cases devant le roi
+        U64 front = shift_up(kbb, c);
+        int shield = bb_count((front | shift_east(front) | shift_west(front)) & pieces(p,c,PAWN));
+        acc.add(KING_SHIELD, shield);
+        if(shield==0 && phase>8) acc.add(KING_NO_SHIELD, 1);
 
-        // développement
-        if(phase > 12){
-            if(t==KNIGHT && is_knight_start(c,s)) mg -= 10;
-            if(t==BISHOP && is_bishop_start(c,s)) mg -= 10;
-        }
+        // roi actif en finale
+        if(phase<8) acc.add(KING_ACTIVE, 3-r);
+    }
+}
 
-        // pions
-        if(t==PAWN){
-            int f = file_of(s);
-            int rRank = rank_of(s);
-            int r = (c==WHITE ? rRank : 7-rRank);
-
-            bool doubled  = myPawns[f] > 1;
-            bool isolated = ((f==0 || myPawns[f-1]==0) &&
-                             (f==7 || myPawns[f+1]==0));
-            if(doubled){  mg -= 10; eg -= 5; }
-            if(isolated){ mg -= 15; eg -=10; }
-
-            // pion arriéré (simple)
-            bool backward = false;
-            if(!isolated){
-                bool frontEnemy = false;
-                if(c==WHITE){
-                    for(int rr=rRank+1; rr<8; ++rr){
-                        Piece pc2 = p.board[sq(f,rr)];
-                        if(pc2!=EMPTY && piece_color(pc2)==(c^1) && piece_type(pc2)==PAWN){
-                            frontEnemy = true; break;
-                        }
-                    }
-                }else{
-                    for(int rr=rRank-1; rr>=0; --rr){
-                        Piece pc2 = p.board[sq(f,rr)];
-                        if(pc2!=EMPTY && piece_color(pc2)==(c^1) && piece_type(pc2)==PAWN){
-                            frontEnemy = true; break;
-                        }
-                    }
-                }
-                bool hasSupport = false;
-                if(c==WHITE){
-                    for(int df=-1; df<=1; df+=2){
-                        int ff=f+df; if(ff<0||ff>7)continue;
-                        for(int rr=0; rr<=rRank; ++rr){
-                            Piece pc2=p.board[sq(ff,rr)];
-                            if(pc2!=EMPTY && piece_color(pc2)==c && piece_type(pc2)==PAWN){
-                                hasSupport=true; break;
-                            }
-                        }
-                    }
-                }else{
-                    for(int df=-1; df<=1; df+=2){
-                        int ff=f+df; if(ff<0||ff>7)continue;
-                        for(int rr=7; rr>=rRank; --rr){
-                            Piece pc2=p.board[sq(ff,rr)];
-                            if(pc2!=EMPTY && piece_color(pc2)==c && piece_type(pc2)==PAWN){
-                                hasSupport=true; break;
-                            }
-                        }
-                    }
-                }
-                backward = frontEnemy && !hasSupport;
-            }
-            if(backward){ mg -= 10; eg -= 10; }
-
-            // pion passé
-            bool blocked=false;
-            for(int rr=rRank+(c==WHITE?1:-1);
-                (c==WHITE? rr<8:rr>=0);
-                rr+=(c==WHITE?1:-1)){
-                int sqf = sq(f,rr);
-                Piece pc2=p.board[sqf];
-                if(pc2!=EMPTY && piece_color(pc2)==(c^1) && piece_type(pc2)==PAWN){
-                    blocked=true;break;
-                }
-            }
-            if(!blocked){
-                int bonus = r*10;
-                mg += bonus;
-                eg += bonus*2;
-
-                // protégé par pion
-                bool protectedByPawn=false;
-                int dir=(c==WHITE?1:-1);
-                int defRank=rRank-dir;
-                if(defRank>=0&&defRank<8){
-                    for(int df=-1; df<=1; df+=2){
-                        int ff=f+df; if(ff<0||ff>7)continue;
-                        Piece pc2=p.board[sq(ff,defRank)];
-                        if(pc2!=EMPTY && piece_color(pc2)==c && piece_type(pc2)==PAWN){
-                            protectedByPawn=true; break;
-                        }
-                    }
-                }
-                if(protectedByPawn){ mg += 15; eg += 25; }
-
-                // pion passé connecté
-                bool connected=false;
-                for(int df=-1; df<=1; df+=2){
-                    int ff=f+df; if(ff<0||ff>7)continue;
-                    for(int rr=0; rr<8; ++rr){
-                        Piece pc2=p.board[sq(ff,rr)];
-                        if(pc2!=EMPTY && piece_color(pc2)==c && piece_type(pc2)==PAWN){
-                            connected=true; break;
-                        }
-                    }
-                }
-                if(connected){ mg += 10; eg += 15; }
-            }
-        }
-
-        // mobilité
-        if(t==KNIGHT){
-            U64 att = knight_att[s] & ~own_occ;
-            mg += 2 * bb_count(att);
-        }else if(t==BISHOP){
-            U64 att = bishop_attacks(s,all_occ) & ~own_occ;
-            mg += 2 * bb_count(att);
-        }else if(t==ROOK){
-            U64 att = rook_attacks(s,all_occ) & ~own_occ;
-            int mob = bb_count(att);
-            mg += mob;
-            int f=file_of(s);
-            int my = myPawns[f];
-            int op = oppPawns[f];
-            if(my==0 && op==0){       // colonne ouverte
-                mg += 15; eg += 10;
-            }else if(my==0 && op>0){ // semi-ouverte
-                mg += 8;  eg += 5;
-            }
-        }else if(t==QUEEN){
-            U64 att = queen_attacks(s,all_occ) & ~own_occ;
-            int mob = bb_count(att);
-            mg += mob;
-            eg += mob;
-        }
-    }
-
-    // sécurité roi
-    U64 kbb = p.bb[c][KING];
-    if(kbb){
-        int ks = __builtin_ctzll(kbb);
-        int r = (c==WHITE? rank_of(ks): 7-rank_of(ks));
-        bool castled = is_king_castled(c,ks);
-        if(castled) mg += 30;
-        else if(phase > 12 && (ks==sq(4,0) || ks==sq(4,7))) mg -= 30;
-
-        // bouclier de pions
-        int shield = 0;
-        int kf=file_of(ks), kr=rank_of(ks);
-        for(int df=-1; df<=1; df++){
-            int ff=kf+df;
-            int rr=kr + (c==WHITE?1:-1);
-            if(ff<0||ff>7||rr<0||rr>7) continue;
-            Piece pc = p.board[sq(ff,rr)];
-            if(pc!=EMPTY && piece_color(pc)==c && piece_type(pc)==PAWN)
-                shield++;
-        }
-        mg += shield*8;
-        if(shield==0 && phase>8) mg -= 20;
-
-        // roi actif en finale
-        if(phase<8){
-            eg += (3-r)*5;
-        }
-    }
+// éval d'un camp
+inline int eval_side(const Position &p, Color c, int phase, const PawnEntry &pe){
+    // matériel + PST : déjà maintenus dans la position ; pions : cache
+    EvalScore s{p.psq_mg[c] + pe.mg[c], p.psq_eg[c] + pe.eg[c]};
+    eval_pieces(p,c,phase,s);
 
     if(phase<0) phase=0;
     if(phase>24) phase=24;
 
     // CORRECTION : plus de matériel = plus de poids pour mg
-    int score = (mg*phase + eg*(24-phase)) / 24;
+    int score = (s.mg*phase + s.eg*(24-phase)) / 24;
     return score;
 }
 
-// éval globale
-inline int eval(const Position &p){
-    int phase=0;
-    for(int c=0;c<2;c++){
-        for(int t=KNIGHT;t<=QUEEN;t++){
-            int w = (t==QUEEN?4:(t==ROOK?2:1));
-            phase += w * bb_count(p.bb[c][t]);
-        }
+// choix du backend (hors recherche) ; false si aucun réseau n'est chargé
+inline bool set_eval_backend(bool nnue){
+    use_nnue = nnue && nnue_loaded();
+    return use_nnue == nnue;
+}
+
+// éval globale ; NNUE : 'acc' est l'accumulateur de p (pile de la recherche),
+// recalculé depuis les bitboards si absent
+inline int eval(const Position &p, PawnTable *pt = nullptr, const Accumulator *acc = nullptr){
+    PROF_SCOPE(PROF_EVAL);
+    if(use_nnue){
+        Accumulator tmp;
+        if(!acc){ nnue_refresh(tmp, p); acc = &tmp; }
+        return std::clamp(nnue_evaluate(*acc, p.stm), -MATE/2, MATE/2);
     }
+
+    int phase=p.phase;
     if(phase>24) phase=24;
     if(phase<0)  phase=0;
 
-    int pawnFileCount[2][8] = {};
-    for(int s=0; s<64; ++s){
-        Piece pc = p.board[s];
-        if(pc==EMPTY) continue;
-        if(piece_type(pc)!=PAWN) continue;
-        int c = piece_color(pc);
-        int f = file_of(s);
-        pawnFileCount[c][f]++;
-    }
+    PawnEntry tmp;
+    const PawnEntry &pe = probe_pawns(p,tmp,pt);
 
-    int white = eval_side(p,WHITE,phase,pawnFileCount);
-    int black = eval_side(p,BLACK,phase,pawnFileCount);
+    int white = eval_side(p,WHITE,phase,pe);
+    int black = eval_side(p,BLACK,phase,pe);
     int score = white - black;
     return (p.stm==WHITE ? score : -score);
 }
 
+// --- Etat de recherche propre à chaque thread ---
+
+constexpr int MAX_PLY = 64;
+
+struct Engine;
+
+// Compteur à un seul écrivain (son thread de recherche), lu par les autres
+// pendant la recherche (rapports, limite de noeuds) : load/store relaxés,
+// sans RMW verrouillé, ce qui suffit à éviter la course de données.
+template<class T>
+struct Relaxed {
+    std::atomic<T> v{0};
+
+    Relaxed() = default;
+    Relaxed(T x) : v(x) {}
+    Relaxed(const Relaxed &o) : v(o.load()) {}
+    Relaxed &operator=(const Relaxed &o){ store(o.load()); return *this; }
+    Relaxed &operator=(T x){ store(x); return *this; }
+
+    T load() const { return v.load(std::memory_order_relaxed); }
+    void store(T x){ v.store(x, std::memory_order_relaxed); }
+    operator T() const { return load(); }
+    Relaxed &operator+=(T x){ store(load() + x); return *this; }
+    Relaxed &operator++(){ return *this += 1; }
+    void operator++(int){ *this += 1; }
+};
+
+// compteurs de recherche, assez bon marché pour rester actifs en production
+struct SearchStats {
+    Relaxed<U64> qnodes;
+    Relaxed<U64> tt_probes, tt_hits;
+    Relaxed<U64> fail_high, fail_high_first; // coupures / coupures sur le 1er coup
+    Relaxed<U64> tb_hits;
+    Relaxed<int> seldepth;                   // ply max atteint depuis la racine
+
+    double tt_hit_rate() const { return tt_probes ? double(tt_hits) / tt_probes : 0.0; }
+    double fail_high_first_rate() const { return fail_high ? double(fail_high_first) / fail_high : 0.0; }
+};
+
+inline void add_stats(SearchStats &a,const SearchStats &b){
+    a.qnodes += b.qnodes;
+    a.tt_probes += b.tt_probes;
+    a.tt_hits += b.tt_hits;
+    a.fail_high += b.fail_high;
+    a.fail_high_first += b.fail_high_first;
+    a.tb_hits += b.tb_hits;
+    a.seldepth = std::max<int>(a.seldepth, b.seldepth);
+}
+
+// --- Move ordering : état du sélecteur ---
+
+struct SearchThread;
+
+// Chaque étape ne génère/score ses coups qu'au moment où on l'atteint :
+// la plupart des coupures arrivent sur le coup TT ou la première capture.
+enum PickStage {
+    PS_TT, PS_GEN_CAPTURES, PS_GOOD_CAPTURES, PS_KILLERS,
+    PS_GEN_QUIETS, PS_QUIETS, PS_BAD_CAPTURES, PS_DONE
+};
+
+struct MovePicker {
+    const Position *p;
+    const SearchThread *t;
+    int ttMove;
+    int ply;              // depuis la racine
+    bool capturesOnly;    // quiescence : étapes captures uniquement
+    int stage;
+    int killers[2];
+    int killerIdx;
+    int moves[256], scores[256];
+    int n, idx;           // coups de l'étape courante
+    int bad[256];
+    int nBad, badIdx;     // captures perdantes, gardées pour la fin
+};
+
+// pile de recherche : tout ce qu'un ply touche, contigu (indexée depuis la racine)
+struct SearchStack {
+    int killers[2]{};
+    int static_eval = 0;
+    Undo undo;
+    MovePicker mp;
+};
+
+// quiescence comprise ; une prise par ply en quiescence, donc jamais atteint
+constexpr int STACK_PLY = MAX_PLY + 64;
+
+// historique : entiers 16 bits divisés par deux avant de saturer
+constexpr int HISTORY_MAX = 1 << 14;
+
+struct SearchThread {
+    int id = 0;
+    Engine *engine = nullptr;            // contexte propriétaire (TT, arrêt, limites)
+    int16_t history_heur[2][64][64]{};   // [color][from][to]
+    SearchStack stack[STACK_PLY];        // [ply depuis la racine]
+    Accumulator acc[STACK_PLY+1];        // NNUE, [ply depuis la racine] ; quiescence joue encore au dernier ply
+    U64 rep_history[4096]{};             // historique pour la recherche
+    int root_ply = 0;                    // ply absolu de la racine
+    int pv[MAX_PLY+1][MAX_PLY+1]{};      // PV triangulaire, indexée par ply depuis la racine
+    int pv_len[MAX_PLY+1]{};
+    int root_skip[256]{};                // MultiPV : coups racine déjà pris par une ligne précédente
+    int root_skip_n = 0;
+    Relaxed<U64> nodes;                  // lu par get_nodes() depuis les autres threads
+    SearchStats stats;
+    // résultat de la dernière itération terminée
+    int best_move = 0;
+    int best_score = -INF;
+    int completed_depth = 0;
+    PawnTable pawns;                     // cache de structure de pions
+};
+
+// --- Pile d'accumulateurs NNUE ---
+// Position ne porte aucun état NNUE : make_move déduit acc[sp+1] de acc[sp],
+// unmake_move n'a rien à défaire (le parent est intact dans la pile).
+
+// p : position après make_move(p, m, u) joué au ply sp
+inline void nnue_push(SearchThread &t, int sp, const Position &p, int m, const Undo &u){
+    if(!use_nnue) return;
+    Accumulator &a = t.acc[sp+1];
+    a = t.acc[sp];
+    int us = p.stm ^ 1, from = move_from(m), to = move_to(m);
+    int moved = piece_type(p.board[to]);
+    nnue_sub(a, us, (m & MF_PROMO) ? PAWN : moved, from);
+    nnue_add(a, us, moved, to);
+    if(u.captured != EMPTY){
+        int cap_sq = (m & MF_ENPASSANT) ? to + (us==WHITE ? -8 : 8) : to;
+        nnue_sub(a, piece_color(u.captured), piece_type(u.captured), cap_sq);
+    }
+    int back = us==WHITE ? 0 : 56;
+    if(m & MF_KSCASTLE)      nnue_move(a, us, ROOK, back+7, back+5);
+    else if(m & MF_QSCASTLE) nnue_move(a, us, ROOK, back,   back+3);
+}
+
+// coup nul : le matériel ne change pas
+inline void nnue_push_null(SearchThread &t, int sp){
+    if(use_nnue) t.acc[sp+1] = t.acc[sp];
+}
+
 // --- 3 répétitions & 50 coups ---
 
-inline int repetition_count(const Position &p, int ply){
+inline int repetition_count(const SearchThread &t, const Position &p, int ply){
     int start = ply - p.halfmove;
     if(start < 0) start = 0;
     int count = 0;
     for(int i = ply; i >= start; --i){
-        if(rep_history[i] == p.key) ++count;
+        if(t.rep_history[i] == p.key) ++count;
     }
     return count;
 }
 
 // --- TT & recherche ---
 
-inline int tt_index(U64 key){
-    return (int)((key>>32)&(TT_SIZE-1));
+inline void tt_clear(TranspositionTable &tt){
+    for(size_t i=0;i<tt.count;i++){
+        for(TTEntry &e : tt.buckets[i].e)
+            e.data.store(0, std::memory_order_relaxed);
+    }
+    tt.generation = 0;
+}
+
+// (ré)alloue la table à 'mb' Mo ; pages de 2 Mo si le système le permet
+inline void tt_resize(TranspositionTable &tt,size_t mb){
+    if(mb < 1) mb = 1;
+    if(tt.buckets){
+        std::free(tt.buckets);
+        tt.buckets = nullptr;
+    }
+    constexpr size_t ALIGN = 2*1024*1024;
+    size_t bytes = mb*1024*1024;
+    bytes = (bytes + ALIGN-1) / ALIGN * ALIGN;
+    void *mem = std::aligned_alloc(ALIGN, bytes);
+    if(!mem) throw std::bad_alloc();
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+    madvise(mem, bytes, MADV_HUGEPAGE);
+#endif
+    tt.buckets = static_cast<TTBucket*>(mem);
+    tt.count   = bytes / sizeof(TTBucket);
+    tt.bytes   = bytes;
+    for(size_t i=0;i<tt.count;i++) new (&tt.buckets[i]) TTBucket();
+    tt.generation = 0;
+}
+
+inline size_t tt_size_mb(const TranspositionTable &tt){ return tt.bytes / (1024*1024); }
+
+inline void tt_new_search(TranspositionTable &tt){ tt.generation = (tt.generation + 1) & 63; }
+
+// raccourcis sur la table du moteur principal
+inline void tt_clear(){ tt_clear(TT); }
+inline void tt_resize(size_t mb){ tt_resize(TT, mb); }
+inline size_t tt_size_mb(){ return tt_size_mb(TT); }
+
+inline TTBucket &tt_bucket(TranspositionTable &tt,U64 key){
+    return tt.buckets[(size_t)(((unsigned __int128)key * tt.count) >> 64)];
+}
+
+// à appeler juste après make_move : le bucket arrive en cache pendant le reste du nœud
+inline void tt_prefetch(TranspositionTable &tt,U64 key){
+    __builtin_prefetch(&tt_bucket(tt,key));
+}
+
+inline int tt_check(U64 key){ return (int)(key & 0xFFFF); }
+
+inline U64 tt_pack(U64 key,int move16,int score,int depth,int genbound){
+    return (U64)(uint16_t)move16
+         | ((U64)(uint16_t)score   << 16)
+         | ((U64)(uint8_t)depth    << 32)
+         | ((U64)(uint8_t)genbound << 40)
+         | ((U64)tt_check(key)     << 48);
+}
+inline int tt_move16(U64 d)  { return (int)(d & 0xFFFF); }
+inline int tt_score(U64 d)   { return (int16_t)((d >> 16) & 0xFFFF); }
+inline int tt_depth(U64 d)   { return (int8_t)((d >> 32) & 0xFF); }
+inline int tt_genbound(U64 d){ return (int)((d >> 40) & 0xFF); }
+inline int tt_key16(U64 d)   { return (int)(d >> 48); }
+inline int tt_gen(int genbound)  { return genbound >> 2; }
+inline int tt_flag(int genbound) { return (genbound & 3) - 1; }
+
+// coup complet depuis les 16 bits de la TT : les drapeaux se déduisent de la position
+inline int tt_decode_move(const Position &p,int m16){
+    if(!m16) return 0;
+    int from=m16 & 63, to=(m16>>6) & 63;
+    Piece pc=p.board[from];
+    if(pc==EMPTY) return 0;
+    int t=piece_type(pc), flags=0;
+    if(p.board[to]!=EMPTY)              flags |= MF_CAPTURE;
+    if(t==PAWN && to==p.ep)             flags |= MF_CAPTURE|MF_ENPASSANT;
+    if(t==KING && to-from==2)           flags |= MF_KSCASTLE;
+    if(t==KING && from-to==2)           flags |= MF_QSCASTLE;
+    if(m16 >> 12)                       flags |= MF_PROMO;
+    return m16 | flags;
 }
 
-inline int probe_tt(U64 key,int depth,int alpha,int beta,int &ttMove){
-    TTEntry &e=TT[tt_index(key)];
-    if(e.key!=key) return std::numeric_limits<int>::min();
-    ttMove=e.move;
-    if(e.depth>=depth){
-        int s=e.score;
-        if(e.flag==0) return s;          // exact
-        if(e.flag==1 && s<=alpha) return alpha; // upper
-        if(e.flag==2 && s>=beta)  return beta;  // lower
+inline int probe_tt(TranspositionTable &tt,const Position &p,int depth,int alpha,int beta,int &ttMove){
+    PROF_SCOPE(PROF_TT_PROBE);
+    TTBucket &b=tt_bucket(tt,p.key);
+    for(TTEntry &e : b.e){
+        U64 d=e.data.load(std::memory_order_relaxed);
+        int gb=tt_genbound(d);
+        if(!gb || tt_key16(d) != tt_check(p.key)) continue;
+        ttMove=tt_decode_move(p, tt_move16(d));
+        if(tt_depth(d)>=depth){
+            int s=tt_score(d);
+            int flag=tt_flag(gb);
+            if(flag==0) return s;          // exact
+            if(flag==1 && s<=alpha) return alpha; // upper
+            if(flag==2 && s>=beta)  return beta;  // lower
+        }
+        break;
     }
     return std::numeric_limits<int>::min();
 }
 
-inline void store_tt(U64 key,int depth,int score,int flag,int move){
-    TTEntry &e=TT[tt_index(key)];
-    if(depth>=e.depth || e.key==0){
-        e.key=key; e.depth=depth; e.score=score; e.flag=flag; e.move=move;
+// Remplacement : même clé -> mise à jour si pas moins profonde (ou ancienne / exacte),
+// sinon on écrase l'entrée de plus faible valeur depth - 8*âge (vide en priorité).
+inline void store_tt(TranspositionTable &tt,U64 key,int depth,int score,int flag,int move){
+    PROF_SCOPE(PROF_TT_STORE);
+    TTBucket &b=tt_bucket(tt,key);
+    int gen=tt.generation;
+    int m16=move & 0x7FFF;
+    int victim=-1;
+    int victimValue=std::numeric_limits<int>::max();
+    for(int i=0;i<TT_BUCKET_SIZE;i++){
+        U64 od=b.e[i].data.load(std::memory_order_relaxed);
+        int gb=tt_genbound(od);
+        if(!gb){
+            if(victim<0 || victimValue > -1000){ victim=i; victimValue=-1000; }
+            continue;
+        }
+        int d=tt_depth(od);
+        if(tt_key16(od) == tt_check(key)){
+            if(depth < d && tt_gen(gb)==gen && flag!=0) return;
+            if(!m16) m16 = tt_move16(od); // on garde le meilleur coup connu
+            victim=i;
+            break;
+        }
+        int age=(gen - tt_gen(gb)) & 63;
+        int value=d - 8*age;
+        if(value < victimValue){ victim=i; victimValue=value; }
     }
+    b.e[victim].data.store(tt_pack(key, m16, score, depth, gen << 2 | (flag + 1)), std::memory_order_relaxed);
+}
+
+// --- Contexte de recherche ---
+
+// Tout l'état mutable d'une recherche : plusieurs Engine peuvent chercher en
+// même temps (analyse en lot), chacun avec ses threads et sa TT, ou une TT commune.
+struct SearchLimits {
+    int time_ms = 0;    // temps fixe par coup ; 0 = pas de limite de temps
+    int depth   = 64;
+    U64 nodes   = 0;    // 0 = pas de limite
+    // pendule du camp au trait : si clock_ms > 0, le gestionnaire de temps
+    // calcule lui-même les limites souple et dure (time_ms ignoré)
+    int clock_ms  = 0;
+    int inc_ms    = 0;
+    int movestogo = 0;  // 0 = mort subite
+    int multipv   = 1;  // nombre de lignes principales cherchées à la racine
+};
+
+struct SearchReport {
+    int multipv = 1;    // rang de la ligne (1 = meilleur coup)
+    int depth = 0;
+    int seldepth = 0;
+    int score = 0;      // point de vue du camp au trait
+    int mate = 0;       // 0, sinon mat en N coups (N<0 : on est maté)
+    U64 nodes = 0;      // tous threads confondus
+    int time_ms = 0;    // depuis le début de la recherche
+    int iter_ms = 0;    // durée de cette itération
+    std::vector<int> pv;
+    SearchStats stats;  // tous threads confondus
+};
+
+// entrée de TT publiée vers d'autres moteurs (analyse distribuée, cluster.cpp)
+struct TTShare {
+    U64 key;
+    int16_t score;
+    uint16_t move;      // 16 bits de la TT
+    int8_t depth;
+    int8_t flag;        // 0 exact, 1 upper, 2 lower
+};
+
+struct Engine {
+    TranspositionTable own_tt;
+    TranspositionTable *tt = &own_tt;           // peut pointer vers une table partagée
+    bool ages_tt = true;                        // false : *tt est vieillie par son propriétaire
+    std::vector<std::unique_ptr<SearchThread>> pool; // [0] = thread principal
+    std::atomic<bool> stop{false};
+    std::chrono::steady_clock::time_point start;
+    std::atomic<std::chrono::steady_clock::time_point> end; // limite dure, relue par tous les threads (ponderhit)
+    std::atomic<std::chrono::steady_clock::time_point> tm_start; // début du budget de temps
+    std::atomic<int> soft_ms{0};                // limite souple (0 = aucune) : pas de nouvelle itération au-delà
+    U64 node_limit = 0;                         // 0 = pas de limite
+    void (*reporter)(const SearchReport &, void *ctx) = nullptr; // thread principal, à chaque itération terminée
+    void *reporter_ctx = nullptr;               // repassé tel quel à reporter
+    void (*share)(const TTShare &, void *ctx) = nullptr; // tous threads, entrées de profondeur >= share_depth
+    void *share_ctx = nullptr;
+    int share_depth = MAX_PLY + 1;
+    int id_offset = 0;                          // cluster : rang du nœud, décale la désynchronisation des helpers
+    SearchReport last;                          // dernière itération terminée du thread principal
+    int multipv = 1;                            // lignes cherchées par le thread principal
+    std::vector<SearchReport> lines;            // MultiPV : meilleure ligne d'abord ; lines[0] == last
+    U64 history[4096]{};                        // positions jouées avant la racine (répétitions)
+    int history_len = 0;
+};
+
+static Engine main_engine;   // main2 / UCI : utilise TT et game_history
+
+// entrée profonde recopiée vers les autres nœuds ; appelé juste après store_tt
+inline void share_tt(const Engine &e,U64 key,int depth,int score,int flag,int move){
+    if(depth < e.share_depth || !e.share) return;
+    e.share(TTShare{key, (int16_t)score, (uint16_t)(move & 0x7FFF), (int8_t)depth, (int8_t)flag}, e.share_ctx);
+}
+
+inline void set_threads(Engine &e,int n){
+    if(n < 1) n = 1;
+    e.pool.clear();
+    for(int i=0;i<n;i++){
+        e.pool.push_back(std::make_unique<SearchThread>());
+        e.pool.back()->id = i;
+        e.pool.back()->engine = &e;
+    }
+}
+
+inline U64 get_nodes(const Engine &e){
+    U64 total = 0;
+    for(auto &t : e.pool) total += t->nodes;
+    return total;
+}
+
+inline SearchStats get_stats(const Engine &e){
+    SearchStats st;
+    for(auto &t : e.pool) add_stats(st, t->stats);
+    return st;
+}
+
+// historique de partie vu par la recherche (la dernière entrée = la racine)
+inline void set_history(Engine &e,const U64 *keys,int n){
+    e.history_len = std::clamp(n, 0, 4096);
+    for(int i=0;i<e.history_len;i++) e.history[i] = keys[i];
+}
+
+// fin de recherche : temps écoulé ou budget de noeuds atteint
+inline bool out_of_budget(const SearchThread &t){
+    const Engine &e = *t.engine;
+    if(e.node_limit && (t.nodes & 255)==0 && get_nodes(e) >= e.node_limit) return true;
+    return std::chrono::steady_clock::now() >= e.end.load(std::memory_order_relaxed);
+}
+
+// --- Gestion du temps ---
+
+constexpr int TIME_OVERHEAD_MS = 30;   // marge pour la latence GUI / système
+
+// budget d'un coup depuis la pendule : limite souple (visée) et dure (jamais dépassée)
+inline void time_allocate(const SearchLimits &lim,int &soft_ms,int &hard_ms){
+    int left = std::max(lim.clock_ms - TIME_OVERHEAD_MS, 1);
+    int mtg  = lim.movestogo > 0 ? std::min(lim.movestogo, 50) : 30;
+    soft_ms = left / mtg + lim.inc_ms * 3 / 4;
+    hard_ms = std::min(soft_ms * 4, left / 3 + lim.inc_ms);
+    soft_ms = std::clamp(soft_ms, 1, left);
+    hard_ms = std::clamp(hard_ms, soft_ms, left);
+}
+
+// (re)fixe les limites à partir de maintenant, 0 = pas de limite (ponderhit, go infinite)
+inline void set_time_budget(Engine &e,int soft_ms,int hard_ms){
+    auto now = std::chrono::steady_clock::now();
+    auto end = hard_ms > 0 ? now + std::chrono::milliseconds(hard_ms)
+                           : std::chrono::steady_clock::time_point::max();
+    e.tm_start.store(now, std::memory_order_relaxed);
+    e.soft_ms.store(soft_ms, std::memory_order_relaxed);
+    e.end.store(end, std::memory_order_relaxed);
 }
 
-static std::chrono::steady_clock::time_point search_end;
-static bool stop_search=false;
-static int nodes=0;
+// temps fixe : pas de limite souple, on cherche jusqu'à l'échéance
+inline void set_search_time(Engine &e,int time_ms){ set_time_budget(e, 0, time_ms); }
 
-inline int get_nodes(){ return nodes; }
+// raccourcis sur le moteur principal
+inline void set_threads(int n){ main_engine.tt = &TT; set_threads(main_engine, n); }
+inline int get_threads(){ return (int)main_engine.pool.size(); }
+inline U64 get_nodes(){ return get_nodes(main_engine); }
+inline void set_search_time(int time_ms){ set_search_time(main_engine, time_ms); }
+inline void set_time_budget(int soft_ms,int hard_ms){ set_time_budget(main_engine, soft_ms, hard_ms); }
+inline const SearchReport &last_report(){ return main_engine.last; }
+inline const std::vector<SearchReport> &last_lines(){ return main_engine.lines; }
 
 // null-move
 inline bool has_non_pawn_material(const Position &p, Color c){
-    return (p.bb[c][KNIGHT] | p.bb[c][BISHOP] | p.bb[c][ROOK] | p.bb[c][QUEEN]) != 0;
+    return (pieces(p,c,KNIGHT) | pieces(p,c,BISHOP) | pieces(p,c,ROOK) | pieces(p,c,QUEEN)) != 0;
 }
 
 inline void make_null_move(Position &p, Undo &u){
-    u.prev = p;
+    u.captured = EMPTY;
+    u.castling = p.castling;
+    u.ep       = p.ep;
+    u.halfmove = p.halfmove;
+    u.key      = p.key;
     if(p.ep != -1){
         p.key ^= zob_ep[file_of(p.ep)];
     }
@@ -1091,76 +1846,273 @@ inline void make_null_move(Position &p, Undo &u){
     p.key ^= zob_side;
 }
 
-// move ordering
-struct ScoredMove{
-    int move;
-    int score;
-};
+inline void unmake_null_move(Position &p, const Undo &u){
+    p.stm = (Color)(p.stm ^ 1);
+    p.ep  = u.ep;
+    p.key = u.key;
+}
 
-inline int score_move(const Position &p, int m, int ttMove, int ply){
-    int s = 0;
-    if(m == ttMove) s += 100000000;
-
-    bool isCap = move_is_capture(m);
-    if(isCap){
-        int from = move_from(m);
-        int to   = move_to(m);
-        Piece attacker = p.board[from];
-        int attackerT = attacker ? piece_type(attacker) : 6;
-        int victimT;
-        if(m & MF_ENPASSANT){
-            victimT = PAWN;
-        }else{
-            Piece victim = p.board[to];
-            victimT = victim ? piece_type(victim) : 6;
+// --- Tables de finales Syzygy ---
+// Sonde optionnelle : compiler avec -DUSE_SYZYGY et le sondeur Fathom
+// (tbprobe.c/.h, fichiers .rtbw/.rtbz projetés en mémoire). Sans lui
+// tb_largest() vaut 0 et aucune sonde n'est faite.
+
+// gains de table : sous les scores de mat, au-dessus de toute éval
+constexpr int TB_WIN_SCORE = MATE - 4096 - 2*MAX_PLY;
+static int tb_probe_depth = 1;   // profondeur restante minimale pour sonder dans l'arbre
+
+inline bool syzygy_init(const std::string &path){
+#ifdef USE_SYZYGY
+    return tb_init(path.c_str());
+#else
+    (void)path;
+    return false;
+#endif
+}
+
+inline int tb_largest(){
+#ifdef USE_SYZYGY
+    return (int)TB_LARGEST;
+#else
+    return 0;
+#endif
+}
+
+inline bool tb_can_probe(const Position &p){
+    return p.castling == 0 && bb_count(occupied(p)) <= tb_largest();
+}
+
+// score de recherche d'un résultat WDL (-2..2, vu du trait) ; les gains
+// ou pertes annulés par la règle des 50 coups comptent comme nulles
+inline int tb_score(int wdl, int ply){
+    if(wdl >  1) return  TB_WIN_SCORE - ply;
+    if(wdl < -1) return -TB_WIN_SCORE + ply;
+    return 0;
+}
+
+// WDL de la position, à n'utiliser que juste après une prise ou un coup de pion
+inline bool syzygy_probe_wdl(const Position &p, int &wdl){
+#ifdef USE_SYZYGY
+    unsigned r = tb_probe_wdl(p.occ[WHITE], p.occ[BLACK],
+                              p.by_type[KING],
+                              p.by_type[QUEEN],
+                              p.by_type[ROOK],
+                              p.by_type[BISHOP],
+                              p.by_type[KNIGHT],
+                              p.by_type[PAWN],
+                              0, 0, p.ep == -1 ? 0 : p.ep, p.stm == WHITE);
+    if(r == TB_RESULT_FAILED) return false;
+    wdl = (int)r - 2;
+    return true;
+#else
+    (void)p; (void)wdl;
+    return false;
+#endif
+}
+
+// racine : coup qui garde le résultat en convertissant au plus vite (DTZ)
+inline bool syzygy_probe_root(Position &p, int &move, int &wdl){
+#ifdef USE_SYZYGY
+    unsigned r = tb_probe_root(p.occ[WHITE], p.occ[BLACK],
+                               p.by_type[KING],
+                               p.by_type[QUEEN],
+                               p.by_type[ROOK],
+                               p.by_type[BISHOP],
+                               p.by_type[KNIGHT],
+                               p.by_type[PAWN],
+                               p.halfmove, 0, p.ep == -1 ? 0 : p.ep, p.stm == WHITE, nullptr);
+    if(r == TB_RESULT_FAILED || r == TB_RESULT_CHECKMATE || r == TB_RESULT_STALEMATE) return false;
+    static const int PROMO[5] = {0, QUEEN, ROOK, BISHOP, KNIGHT}; // ordre Fathom
+    int from = (int)TB_GET_FROM(r), to = (int)TB_GET_TO(r);
+    unsigned pr = TB_GET_PROMOTES(r);
+    int promo = pr < 5 ? PROMO[pr] : 0;
+    int moves[256];
+    int n = generate_legal_moves(p, moves);
+    for(int i=0;i<n;i++){
+        int m = moves[i];
+        if(move_from(m)==from && move_to(m)==to && (move_is_promo(m) ? move_promo(m) : 0)==promo){
+            move = m;
+            wdl = (int)TB_GET_WDL(r) - 2;
+            return true;
         }
-        s += 1000000 + MVV_LVA[victimT][attackerT];
-        if(m & MF_PROMO) s += 5000;
-    }else{
-        if(m & (MF_KSCASTLE|MF_QSCASTLE)){
-            s += 20000;
-        }else{
-            if(ply < MAX_PLY){
-                if(m == killer_moves[0][ply])      s += 9000;
-                else if(m == killer_moves[1][ply]) s += 8000;
-            }
-            Color us = p.stm;
-            int from = move_from(m), to = move_to(m);
-            s += history_heur[us][from][to];
+    }
+    return false;
+#else
+    (void)p; (void)move; (void)wdl;
+    return false;
+#endif
+}
+
+// --- Move ordering : sélection par étapes ---
+
+inline void init_picker(MovePicker &mp,const Position &p,const SearchThread &t,int ttMove,int ply,bool capturesOnly=false){
+    mp.p = &p;
+    mp.t = &t;
+    mp.ttMove = ttMove;
+    mp.ply = ply;
+    mp.capturesOnly = capturesOnly;
+    mp.stage = PS_TT;
+    mp.killers[0] = mp.killers[1] = 0;
+    if(!capturesOnly){
+        mp.killers[0] = t.stack[ply].killers[0];
+        mp.killers[1] = t.stack[ply].killers[1];
+    }
+    mp.killerIdx = 0;
+    mp.n = mp.idx = 0;
+    mp.nBad = mp.badIdx = 0;
+}
+
+inline int capture_victim_type(const Position &p,int m){
+    if(m & MF_ENPASSANT) return PAWN;
+    Piece victim = p.board[move_to(m)];
+    return victim ? piece_type(victim) : 6;
+}
+
+// capture perdante selon SEE (les promotions restent dans les bonnes captures)
+inline bool is_bad_capture(const Position &p,int m){
+    if(m & MF_PROMO) return false;
+    int attackerT = piece_type(p.board[move_from(m)]);
+    if(VAL[capture_victim_type(p,m)] >= VAL[attackerT] && attackerT!=KING) return false;
+    return see(p,m) < 0;
+}
+
+// sélection du meilleur restant (tri paresseux)
+inline int pick_best(MovePicker &mp){
+    int best = mp.idx;
+    for(int i=mp.idx+1;i<mp.n;i++)
+        if(mp.scores[i] > mp.scores[best]) best = i;
+    std::swap(mp.moves[mp.idx], mp.moves[best]);
+    std::swap(mp.scores[mp.idx], mp.scores[best]);
+    return mp.moves[mp.idx++];
+}
+
+inline int next_move(MovePicker &mp){
+    const Position &p = *mp.p;
+    switch(mp.stage){
+    case PS_TT:
+        mp.stage = PS_GEN_CAPTURES;
+        if(mp.ttMove && (!mp.capturesOnly || move_is_capture(mp.ttMove)) && move_is_legal(p, mp.ttMove))
+            return mp.ttMove;
+        [[fallthrough]];
+
+    case PS_GEN_CAPTURES:
+        mp.n = generate_legal_moves(p, mp.moves, GEN_CAPTURES);
+        mp.idx = 0;
+        for(int i=0;i<mp.n;i++){
+            int m = mp.moves[i];
+            int attackerT = piece_type(p.board[move_from(m)]);
+            mp.scores[i] = MVV_LVA[capture_victim_type(p,m)][attackerT] + ((m & MF_PROMO) ? 5000 : 0);
+        }
+        mp.stage = PS_GOOD_CAPTURES;
+        [[fallthrough]];
+
+    case PS_GOOD_CAPTURES:
+        while(mp.idx < mp.n){
+            int m = pick_best(mp);
+            if(m == mp.ttMove) continue;
+            if(is_bad_capture(p, m)){ mp.bad[mp.nBad++] = m; continue; }
+            return m;
+        }
+        // quiescence : les captures SEE<0 sont élaguées
+        mp.stage = mp.capturesOnly ? PS_DONE : PS_KILLERS;
+        if(mp.capturesOnly) return 0;
+        [[fallthrough]];
+
+    case PS_KILLERS:
+        while(mp.killerIdx < 2){
+            int k = mp.killers[mp.killerIdx++];
+            if(k && k != mp.ttMove && !move_is_capture(k) && move_is_legal(p, k))
+                return k;
         }
+        mp.stage = PS_GEN_QUIETS;
+        [[fallthrough]];
+
+    case PS_GEN_QUIETS: {
+        mp.n = generate_legal_moves(p, mp.moves, GEN_QUIETS);
+        mp.idx = 0;
+        const SearchThread &t = *mp.t;
+        for(int i=0;i<mp.n;i++){
+            int m = mp.moves[i];
+            int sc = t.history_heur[p.stm][move_from(m)][move_to(m)];
+            if(m & (MF_KSCASTLE|MF_QSCASTLE)) sc += 20000;
+            if((m & MF_PROMO) && move_promo(m)==QUEEN) sc += 30000;
+            mp.scores[i] = sc;
+        }
+        mp.stage = PS_QUIETS;
+        [[fallthrough]];
+    }
+
+    case PS_QUIETS:
+        while(mp.idx < mp.n){
+            int m = pick_best(mp);
+            if(m == mp.ttMove || m == mp.killers[0] || m == mp.killers[1]) continue;
+            return m;
+        }
+        mp.stage = PS_BAD_CAPTURES;
+        [[fallthrough]];
+
+    case PS_BAD_CAPTURES:
+        if(mp.badIdx < mp.nBad) return mp.bad[mp.badIdx++];
+        mp.stage = PS_DONE;
+        [[fallthrough]];
+
+    default:
+        return 0;
     }
-    return s;
+}
+
+// bonus d'historique d'un coup calme ; le camp est divisé par deux avant saturation
+inline void update_history(SearchThread &t,Color us,int m,int bonus){
+    int16_t &h = t.history_heur[us][move_from(m)][move_to(m)];
+    if(h + bonus > HISTORY_MAX)
+        for(auto &row : t.history_heur[us])
+            for(int16_t &v : row) v /= 2;
+    h += bonus;
+}
+
+// PV triangulaire : pv[sp] = m suivi de la PV du fils
+inline void update_pv(SearchThread &t,int sp,int m){
+    t.pv[sp][0] = m;
+    int n = t.pv_len[sp+1];
+    for(int k=0;k<n;k++) t.pv[sp][k+1] = t.pv[sp+1][k];
+    t.pv_len[sp] = n + 1;
 }
 
 // quiescence
-inline int quiescence(Position &p,int alpha,int beta,int ply){
-    if(stop_search) return 0;
-    if(std::chrono::steady_clock::now()>=search_end){
-        stop_search=true; return 0;
+inline int quiescence(SearchThread &t,Position &p,int alpha,int beta,int ply){
+    if(t.engine->stop) return 0;
+    if(out_of_budget(t)){
+        t.engine->stop=true; return 0;
     }
-    nodes++;
+    t.nodes++;
+    t.stats.qnodes++;
+    PROF_EVENT(PROF_QNODE);
+
+    int sp = ply - t.root_ply;
+    if(sp <= MAX_PLY) t.pv_len[sp] = 0;
+    if(sp > t.stats.seldepth) t.stats.seldepth = sp;
 
-    rep_history[ply] = p.key;
+    t.rep_history[ply] = p.key;
 
-    if(p.halfmove >= 100 || repetition_count(p, ply) >= 3)
+    if(p.halfmove >= 100 || repetition_count(t, p, ply) >= 3)
         return 0;
 
-    int stand=eval(p);
+    int stand=eval(p, &t.pawns, &t.acc[sp]);
     if(stand>=beta) return beta;
     if(stand>alpha) alpha=stand;
-
-    int moves[256];
-    int n=generate_moves(p,moves,true);
-    for(int i=0;i<n;i++){
-        int m=moves[i];
-        Undo u; make_move(p,m,u);
-        if(in_check(p,(Color)(p.stm^1))){
-            unmake_move(p,u); continue;
-        }
-        rep_history[ply+1] = p.key;
-        int score=-quiescence(p,-beta,-alpha,ply+1);
-        unmake_move(p,u);
-        if(stop_search) return 0;
+    if(sp >= STACK_PLY) return alpha; // pile pleine : inatteignable en pratique
+
+    SearchStack &ss = t.stack[sp];
+    MovePicker &mp = ss.mp;
+    init_picker(mp,p,t,0,sp,true);
+    int m;
+    while((m=next_move(mp))){
+        make_move(p,m,ss.undo);
+        nnue_push(t, sp, p, m, ss.undo);
+        t.rep_history[ply+1] = p.key;
+        int score=-quiescence(t,p,-beta,-alpha,ply+1);
+        unmake_move(p,m,ss.undo);
+        if(t.engine->stop) return 0;
         if(score>=beta) return beta;
         if(score>alpha) alpha=score;
     }
@@ -1168,34 +2120,57 @@ inline int quiescence(Position &p,int alpha,int beta,int ply){
 }
 
 // alpha-beta
-inline int search(Position &p,int depth,int alpha,int beta,int ply){
-    if(stop_search) return 0;
-    if(std::chrono::steady_clock::now()>=search_end){
-        stop_search=true; return 0;
+inline int search(SearchThread &t,Position &p,int depth,int alpha,int beta,int ply){
+    if(t.engine->stop) return 0;
+    if(out_of_budget(t)){
+        t.engine->stop=true; return 0;
     }
-    nodes++;
+    t.nodes++;
+
+    int sp = ply - t.root_ply;   // ply depuis la racine
+    if(sp <= MAX_PLY) t.pv_len[sp] = 0;
+    if(sp > t.stats.seldepth) t.stats.seldepth = sp;
 
-    rep_history[ply] = p.key;
+    t.rep_history[ply] = p.key;
 
-    if(p.halfmove >= 100 || repetition_count(p, ply) >= 3)
+    if(p.halfmove >= 100 || repetition_count(t, p, ply) >= 3)
         return 0;
 
     if(depth<=0)
-        return quiescence(p,alpha,beta,ply);
+        return quiescence(t,p,alpha,beta,ply);
 
     Color us = p.stm;
     bool inCheckHere = in_check(p, us);
     int alphaOrig = alpha;
 
+    // pas de coupure TT dans un nœud PV : la variante principale s'arrêterait là
+    bool pvNode = beta - alpha > 1;
     int ttMove=0;
-    int ttScore=probe_tt(p.key,depth,alpha,beta,ttMove);
-    if(ttScore!=std::numeric_limits<int>::min())
+    int ttScore=probe_tt(*t.engine->tt,p,depth,alpha,beta,ttMove);
+    t.stats.tt_probes++;
+    if(ttMove || ttScore!=std::numeric_limits<int>::min()) t.stats.tt_hits++;
+    if(ttScore!=std::numeric_limits<int>::min() && !pvNode)
         return ttScore;
 
+    // tables de finales : résultat exact, conservé dans la TT
+    if(p.halfmove == 0 && ply > t.root_ply && depth >= tb_probe_depth && tb_can_probe(p)){
+        int wdl;
+        if(syzygy_probe_wdl(p, wdl)){
+            t.stats.tb_hits++;
+            int score = tb_score(wdl, ply);
+            int flag = score > 0 ? 2 : score < 0 ? 1 : 0; // gain : borne basse, perte : haute
+            if(flag==0 || (flag==2 && score>=beta) || (flag==1 && score<=alpha)){
+                store_tt(*t.engine->tt, p.key, std::min(depth+6, MAX_PLY), score, flag, 0);
+                return score;
+            }
+        }
+    }
+
+    SearchStack &ss = t.stack[sp];
     int staticEval = 0;
     bool useFutility = false;
     if(depth==1 && !inCheckHere){
-        staticEval = eval(p);
+        staticEval = ss.static_eval = eval(p, &t.pawns, &t.acc[sp]);
         useFutility = true;
         if(staticEval >= beta)
             return staticEval;
@@ -1203,67 +2178,71 @@ inline int search(Position &p,int depth,int alpha,int beta,int ply){
 
     // null move
     if(depth >= 3 && !inCheckHere && has_non_pawn_material(p, us) && ply < MAX_PLY-1){
-        Undo u;
-        make_null_move(p, u);
-        rep_history[ply+1] = p.key;
+        make_null_move(p, ss.undo);
+        nnue_push_null(t, sp);
+        tt_prefetch(*t.engine->tt,p.key);
+        t.rep_history[ply+1] = p.key;
         int R = 2 + (depth > 5 ? 1 : 0);
-        int score = -search(p, depth-1-R, -beta, -beta+1, ply+1);
-        unmake_move(p, u);
-        if(stop_search) return 0;
-        if(score >= beta) return beta;
+        int score = -search(t, p, depth-1-R, -beta, -beta+1, ply+1);
+        unmake_null_move(p, ss.undo);
+        if(t.engine->stop) return 0;
+        if(score >= beta){
+            PROF_EVENT(PROF_NULL_CUT);
+            return beta;
+        }
     }
 
-    int moves[256];
-    int n=generate_moves(p,moves,false);
-    ScoredMove sm[256];
-    for(int i=0;i<n;i++){
-        sm[i].move  = moves[i];
-        sm[i].score = score_move(p, moves[i], ttMove, ply);
-    }
-    std::sort(sm, sm+n, [](const ScoredMove &a,const ScoredMove &b){
-        return a.score > b.score;
-    });
+    MovePicker &mp = ss.mp;
+    init_picker(mp,p,t,ttMove,sp);
 
     int bestScore=-INF;
     int bestMove=0;
-    bool any=false;
+    int i=-1;          // index du coup courant (LMR)
+    int searched=0;    // coups réellement cherchés (PVS)
+    int m;
 
-    for(int i=0;i<n;i++){
-        int m = sm[i].move;
-        Undo u; make_move(p,m,u);
-        if(in_check(p,(Color)(p.stm^1))){
-            unmake_move(p,u); continue;
-        }
-        any=true;
+    while((m=next_move(mp))){
+        ++i;
 
         // futility (depth==1, quiet)
         if(useFutility &&
            !move_is_capture(m) &&
            !(m & (MF_PROMO|MF_ENPASSANT|MF_KSCASTLE|MF_QSCASTLE)) &&
            staticEval + FUTILITY_MARGIN <= alpha){
-            unmake_move(p,u);
+            bestScore = std::max(bestScore, staticEval + FUTILITY_MARGIN);
+            PROF_EVENT(PROF_FUTILITY);
             continue;
         }
 
-        rep_history[ply+1] = p.key;
+        make_move(p,m,ss.undo);
+        nnue_push(t, sp, p, m, ss.undo);
+        tt_prefetch(*t.engine->tt,p.key);
+
+        t.rep_history[ply+1] = p.key;
 
         int score;
         bool isCapture = move_is_capture(m) || (m & MF_PROMO);
 
-        // LMR
-        if(!isCapture && !inCheckHere && depth >= 3 && i > 3 && ply > 0){
-            int R = 1 + (depth > 5 && i > 7 ? 1 : 0);
-            int reducedDepth = depth-1-R;
-            score = -search(p, reducedDepth, -beta, -alpha, ply+1);
-            if(score > alpha){
-                score = -search(p, depth-1, -beta, -alpha, ply+1);
-            }
+        if(searched++ == 0){
+            // premier coup : fenêtre complète
+            score = -search(t,p,depth-1,-beta,-alpha,ply+1);
         }else{
-            score = -search(p,depth-1,-beta,-alpha,ply+1);
+            // PVS : fenêtre nulle (réduite par LMR si coup tardif et calme),
+            // puis recherche complète seulement si le coup bat alpha
+            int newDepth = depth-1;
+            if(!isCapture && !inCheckHere && depth >= 3 && i > 3 && ply > 0)
+                newDepth -= 1 + (depth > 5 && i > 7 ? 1 : 0);
+            score = -search(t, p, newDepth, -alpha-1, -alpha, ply+1);
+            if(score > alpha && newDepth < depth-1){
+                PROF_EVENT(PROF_LMR_RESEARCH);
+                score = -search(t, p, depth-1, -alpha-1, -alpha, ply+1);
+            }
+            if(score > alpha && score < beta)
+                score = -search(t, p, depth-1, -beta, -alpha, ply+1);
         }
 
-        unmake_move(p,u);
-        if(stop_search) return 0;
+        unmake_move(p,m,ss.undo);
+        if(t.engine->stop) return 0;
 
         if(score>bestScore){
             bestScore=score;
@@ -1271,22 +2250,24 @@ inline int search(Position &p,int depth,int alpha,int beta,int ply){
         }
         if(score>alpha){
             alpha=score;
+            if(sp < MAX_PLY) update_pv(t, sp, m);
             if(alpha>=beta){
-                if(!move_is_capture(m) && !(m & (MF_KSCASTLE|MF_QSCASTLE)) && ply < MAX_PLY){
-                    if(killer_moves[0][ply] != m){
-                        killer_moves[1][ply] = killer_moves[0][ply];
-                        killer_moves[0][ply] = m;
+                t.stats.fail_high++;
+                if(searched==1) t.stats.fail_high_first++;
+                if(!move_is_capture(m) && !(m & (MF_KSCASTLE|MF_QSCASTLE))){
+                    if(ss.killers[0] != m){
+                        ss.killers[1] = ss.killers[0];
+                        ss.killers[0] = m;
                     }
-                    int from = move_from(m), to = move_to(m);
-                    history_heur[us][from][to] += depth*depth;
+                    update_history(t, us, m, depth*depth);
                 }
                 break;
             }
         }
     }
 
-    if(!any){
-        if(in_check(p,p.stm)) return -MATE+ply;
+    if(i<0){
+        if(inCheckHere) return -MATE+ply;
         return 0; // pat
     }
 
@@ -1295,88 +2276,404 @@ inline int search(Position &p,int depth,int alpha,int beta,int ply){
     else if(bestScore >= beta)      flag = 2; // lower
     else                            flag = 0; // exact
 
-    store_tt(p.key,depth,bestScore,flag,bestMove);
+    store_tt(*t.engine->tt,p.key,depth,bestScore,flag,bestMove);
+    share_tt(*t.engine,p.key,depth,bestScore,flag,bestMove);
     return bestScore;
 }
 
-// iterative deepening
-inline int search_best_move(Position &p,int time_ms,int max_depth,int &out_move){
-    nodes=0;
-    stop_search=false;
-    search_end=std::chrono::steady_clock::now()+std::chrono::milliseconds(time_ms);
+// --- Rapports de recherche ---
 
-    // reset heuristiques
-    for(int ply=0; ply<MAX_PLY; ++ply){
-        killer_moves[0][ply] = killer_moves[1][ply] = 0;
+// les mats sont notés -MATE+ply avec ply absolu dans la partie
+inline int mate_in(int score,int base_ply){
+    if(std::abs(score) < MATE - 4096 - MAX_PLY) return 0;
+    int plies = MATE - std::abs(score) - base_ply;
+    return score > 0 ? (plies + 1) / 2 : -(plies / 2);
+}
+
+// variante principale reconstruite depuis la TT
+inline std::vector<int> extract_pv(TranspositionTable &tt,Position p,int first,int max_len){
+    std::vector<int> pv;
+    int m = first;
+    while(m && (int)pv.size() < max_len && move_is_legal(p, m)){
+        pv.push_back(m);
+        Undo u; make_move(p, m, u);
+        m = 0;
+        (void)probe_tt(tt, p, 0, -INF, INF, m);
     }
-    for(int c=0;c<2;c++)
-        for(int f=0;f<64;f++)
-            for(int t=0;t<64;t++)
-                history_heur[c][f][t] = 0;
+    return pv;
+}
 
-    // si aucune histoire, on initialise avec la position courante
-    if(game_ply == 0){
-        game_ply = 1;
-        game_history[0] = p.key;
+// PV de la dernière recherche racine ; si la triangulaire ne commence pas par
+// 'best' (itération relancée, coup racine repris), reconstruite depuis la TT
+inline std::vector<int> root_pv(SearchThread &t,const Position &p,int best,int depth){
+    if(t.pv_len[0] > 0 && t.pv[0][0] == best) return std::vector<int>(t.pv[0], t.pv[0] + t.pv_len[0]);
+    return extract_pv(*t.engine->tt, p, best, std::max(depth, 1));
+}
+
+inline std::vector<int> extract_pv(Position p,int first,int max_len){
+    return extract_pv(*main_engine.tt, p, first, max_len);
+}
+
+// racine : comme search() mais garde le meilleur coup ; fail-soft,
+// bestMove n'est mis à jour que si un coup, entièrement cherché, dépasse alpha
+inline int search_root(SearchThread &t,Position &p,int depth,int alpha,int beta,int base_ply,int ttRootMove,int &bestMove){
+    Engine &e = *t.engine;
+    int alphaOrig = alpha;
+    t.pv_len[0] = 0;
+    SearchStack &ss = t.stack[0];
+    MovePicker &mp = ss.mp;
+    init_picker(mp,p,t,ttRootMove,0);
+
+    int bestScore=-INF;
+    int searched=0;
+    int m;
+
+    while((m=next_move(mp))){
+        if(std::find(t.root_skip, t.root_skip + t.root_skip_n, m) != t.root_skip + t.root_skip_n) continue;
+        make_move(p,m,ss.undo);
+        nnue_push(t, 0, p, m, ss.undo);
+        tt_prefetch(*e.tt,p.key);
+        int child_ply = base_ply + 1;
+        if(child_ply < 4096){
+            t.rep_history[child_ply] = p.key;
+        }
+        int score;
+        if(searched++ == 0){
+            score = -search(t,p,depth-1,-beta,-alpha,child_ply);
+        }else{
+            score = -search(t,p,depth-1,-alpha-1,-alpha,child_ply);
+            if(score > alpha && score < beta)
+                score = -search(t,p,depth-1,-beta,-alpha,child_ply);
+        }
+        unmake_move(p,m,ss.undo);
+        // arrêt : 'score' est inutilisable, mais les coups déjà finis restent valables
+        if(e.stop) return bestScore;
+
+        if(score>bestScore) bestScore=score;
+        if(score>alpha){
+            alpha=score;
+            bestMove=m;
+            update_pv(t, 0, m);
+            if(alpha>=beta) break;
+        }
     }
 
-    int maxHist = std::min(game_ply, 4096);
-    for(int i=0;i<maxHist;i++){
-        rep_history[i] = game_history[i];
+    // avec des coups exclus, le score n'est pas celui de la position
+    if(bestMove && t.root_skip_n == 0){
+        int flag = bestScore >= beta ? 2 : (bestScore <= alphaOrig ? 1 : 0);
+        store_tt(*e.tt,p.key,depth,bestScore,flag,bestMove);
+        share_tt(e,p.key,depth,bestScore,flag,bestMove);
     }
-    int base_ply = maxHist - 1;
-    if(base_ply < 0) base_ply = 0;
+    return bestScore;
+}
 
-    int best=0;
-    int bestScore=-INF;
+// racine avec fenêtre d'aspiration autour de 'guess', élargie à chaque échec ;
+// renvoie le meilleur coup (0 si la recherche a été arrêtée)
+inline int search_root_aspirated(SearchThread &t,Position &p,int depth,int base_ply,int guess,bool aspirate,int ttRootMove,int &score){
+    int delta = ASPIRATION_DELTA;
+    int alpha = -INF, beta = INF;
+    if(aspirate){
+        alpha = std::max(guess - delta, -INF);
+        beta  = std::min(guess + delta,  INF);
+    }
+    while(true){
+        int best=0;
+        score = search_root(t,p,depth,alpha,beta,base_ply,ttRootMove,best);
+        if(t.engine->stop) return 0;
+        if(score <= alpha && alpha > -INF){
+            beta  = (alpha + beta) / 2;
+            alpha = std::max(score - delta, -INF);
+        }else if(score >= beta && beta < INF){
+            if(best) ttRootMove = best;
+            beta  = std::min(score + delta, INF);
+        }else{
+            return best;
+        }
+        delta += delta / 2;
+    }
+}
 
-    for(int d=1; d<=max_depth; d++){
-        if(stop_search) break;
+// MultiPV : lignes 2..N à la profondeur 'depth', chacune sans les coups des
+// lignes précédentes ; e.lines[0] vient d'être rempli par l'itération normale.
+// Une ligne interrompue garde le résultat de l'itération précédente.
+inline void search_extra_lines(SearchThread &t,Position &p,int depth,int base_ply,int lines){
+    Engine &e = *t.engine;
+    if((int)e.lines.size() < lines) e.lines.resize(lines);
+    for(int k=1; k<lines && !e.stop; k++){
+        t.root_skip_n = 0;
+        for(int j=0;j<k;j++)
+            if(!e.lines[j].pv.empty()) t.root_skip[t.root_skip_n++] = e.lines[j].pv[0];
+
+        SearchReport &r = e.lines[k];
+        bool known = r.depth > 0 && !r.pv.empty();
+        int ttRootMove = known ? r.pv[0] : 0;
+        int score = -INF;
+        int best = search_root_aspirated(t,p,depth,base_ply,r.score,
+                                         known && depth >= 4 && !mate_in(r.score, base_ply),
+                                         ttRootMove,score);
+        if(!best) break;
+        r.multipv  = k+1;
+        r.depth    = depth;
+        r.score    = score;
+        r.mate     = mate_in(score, base_ply);
+        r.pv       = root_pv(t, p, best, depth);
+    }
+    t.root_skip_n = 0;
+
+    // arrêt en cours de route : une ancienne ligne peut reprendre un coup déjà listé
+    for(size_t k=1; k<e.lines.size(); ){
+        const std::vector<int> &pv = e.lines[k].pv;
+        bool dup = pv.empty();
+        for(size_t j=0; j<k && !dup; j++) dup = !e.lines[j].pv.empty() && e.lines[j].pv[0] == pv[0];
+        if(dup) e.lines.erase(e.lines.begin() + k);
+        else k++;
+    }
 
+    // les lignes secondaires restent triées ; la première est le coup joué
+    std::stable_sort(e.lines.begin() + 1, e.lines.end(),
+                     [](const SearchReport &a,const SearchReport &b){
+                         return a.depth != b.depth ? a.depth > b.depth : a.score > b.score;
+                     });
+    for(size_t k=1;k<e.lines.size();k++) e.lines[k].multipv = (int)k+1;
+}
+
+// iterative deepening d'un thread (Lazy SMP : tous partent de la même racine)
+// Fin d'itération (thread principal) : faut-il en lancer une autre ?
+// La limite souple est allongée si le meilleur coup vient de changer ou si le
+// score chute, raccourcie si le coup est stable ; on ne lance pas une itération
+// qui ne finirait probablement pas avant la limite dure.
+inline bool time_for_next_iteration(const Engine &e,int stability,int scoreDrop,int lastIterMs){
+    int soft = e.soft_ms.load(std::memory_order_relaxed);
+    if(soft <= 0) return true;
+    auto now = std::chrono::steady_clock::now();
+    int elapsed = (int)std::chrono::duration_cast<std::chrono::milliseconds>(
+                      now - e.tm_start.load(std::memory_order_relaxed)).count();
+    int hardLeft = (int)std::chrono::duration_cast<std::chrono::milliseconds>(
+                      e.end.load(std::memory_order_relaxed) - now).count();
+
+    double scale = stability == 0 ? 1.4 : stability >= 4 ? 0.6 : 1.0;
+    if(scoreDrop > 60)      scale *= 1.6;
+    else if(scoreDrop > 25) scale *= 1.25;
+
+    if(elapsed >= soft * scale) return false;
+    // l'itération suivante coûte typiquement 2 à 3 fois la précédente
+    return elapsed < soft * scale * 0.6 || 2 * lastIterMs < hardLeft;
+}
+
+// iterative deepening d'un thread (Lazy SMP : tous partent de la même racine)
+inline void iterative_deepening(SearchThread &t,Position p,int max_depth,int base_ply){
+    Engine &e = *t.engine;
+    t.root_ply = base_ply;
+    if(use_nnue) nnue_refresh(t.acc[0], p);
+    prof_reset_thread();
+    int stability = 0;
+    // MultiPV : le thread principal seul cherche les lignes secondaires
+    int lines = 1;
+    if(t.id==0 && e.multipv > 1){
         int moves[256];
-        int n=generate_moves(p,moves,false);
-        ScoredMove sm[256];
+        lines = std::min(e.multipv, generate_legal_moves(p, moves));
+    }
+    for(int d=1; d<=max_depth; d++){
+        if(e.stop) break;
+        auto iterStart = std::chrono::steady_clock::now();
 
-        int ttRootMove=0;
-        (void)probe_tt(p.key,d,-INF,INF,ttRootMove);
+        // les helpers impairs cherchent une profondeur plus loin pour
+        // désynchroniser les arbres et remplir la TT en avance
+        int depth = std::min(d + ((t.id + e.id_offset) & 1), max_depth);
 
-        for(int i=0;i<n;i++){
-            sm[i].move  = moves[i];
-            sm[i].score = score_move(p, moves[i], ttRootMove, base_ply);
+        int ttRootMove=0;
+        (void)probe_tt(*e.tt,p,depth,-INF,INF,ttRootMove);
+        if(t.best_move) ttRootMove=t.best_move;
+
+        // fenêtre d'aspiration autour du score précédent, élargie à chaque échec
+        int delta = ASPIRATION_DELTA;
+        int alpha = -INF, beta = INF;
+        if(depth >= 4 && t.completed_depth > 0 && !mate_in(t.best_score, base_ply)){
+            alpha = std::max(t.best_score - delta, -INF);
+            beta  = std::min(t.best_score + delta,  INF);
         }
-        std::sort(sm, sm+n, [](const ScoredMove &a,const ScoredMove &b){
-            return a.score > b.score;
-        });
 
         int localBest=0;
         int localScore=-INF;
-
-        for(int i=0;i<n;i++){
-            int m=sm[i].move;
-            Undo u; make_move(p,m,u);
-            if(in_check(p,(Color)(p.stm^1))){
-                unmake_move(p,u); continue;
-            }
-            int child_ply = base_ply + 1;
-            if(child_ply < 4096){
-                rep_history[child_ply] = p.key;
+        while(true){
+            int iterBest=0;
+            localScore = search_root(t,p,depth,alpha,beta,base_ply,ttRootMove,iterBest);
+            if(e.stop){
+                // itération interrompue : un coup qui a battu alpha reste meilleur
+                // que l'ancien (score = borne inférieure)
+                if(iterBest && iterBest != t.best_move && localScore > alpha){
+                    t.best_move = iterBest;
+                    t.best_score = localScore;
+                }
+                break;
             }
-            int score = -search(p,d-1,-INF,INF,child_ply);
-            unmake_move(p,u);
-            if(stop_search) break;
-            if(score>localScore){
-                localScore=score;
-                localBest=m;
+            if(localScore <= alpha && alpha > -INF){
+                beta  = (alpha + beta) / 2;
+                alpha = std::max(localScore - delta, -INF);
+            }else if(localScore >= beta && beta < INF){
+                if(iterBest) ttRootMove = iterBest;
+                beta  = std::min(localScore + delta, INF);
+            }else{
+                localBest = iterBest;
+                break;
             }
+            delta += delta / 2;
         }
-        if(stop_search) break;
+        if(e.stop) break;
         if(localBest){
-            best=localBest;
-            bestScore=localScore;
+            int prevScore = t.completed_depth ? t.best_score : localScore;
+            stability = (localBest == t.best_move) ? stability + 1 : 0;
+            t.best_move=localBest;
+            t.best_score=localScore;
+            t.completed_depth=depth;
+
+            if(t.id==0){
+                auto now = std::chrono::steady_clock::now();
+                SearchReport &r = e.last;
+                r.depth    = depth;
+                r.score    = localScore;
+                r.mate     = mate_in(localScore, base_ply);
+                r.nodes    = get_nodes(e);
+                r.time_ms  = (int)std::chrono::duration_cast<std::chrono::milliseconds>(now - e.start).count();
+                r.iter_ms  = (int)std::chrono::duration_cast<std::chrono::milliseconds>(now - iterStart).count();
+                r.stats    = get_stats(e);
+                r.seldepth = r.stats.seldepth;
+                r.pv       = root_pv(t, p, localBest, depth);
+                if(e.lines.empty()) e.lines.resize(1);
+                e.lines[0] = r;
+
+                if(lines > 1){
+                    search_extra_lines(t, p, depth, base_ply, lines);
+                    now = std::chrono::steady_clock::now();
+                    r.nodes    = get_nodes(e);
+                    r.time_ms  = (int)std::chrono::duration_cast<std::chrono::milliseconds>(now - e.start).count();
+                    r.iter_ms  = (int)std::chrono::duration_cast<std::chrono::milliseconds>(now - iterStart).count();
+                    r.stats    = get_stats(e);
+                    r.seldepth = r.stats.seldepth;
+                    e.lines[0] = r;
+                    for(size_t k=1;k<e.lines.size();k++){
+                        SearchReport &l = e.lines[k];
+                        l.nodes = r.nodes; l.time_ms = r.time_ms; l.iter_ms = r.iter_ms;
+                        l.stats = r.stats; l.seldepth = r.seldepth;
+                    }
+                    if(e.reporter) for(const SearchReport &l : e.lines) e.reporter(l, e.reporter_ctx);
+                }else if(e.reporter){
+                    e.reporter(r, e.reporter_ctx);
+                }
+
+                if(!time_for_next_iteration(e, stability, prevScore - localScore, r.iter_ms))
+                    break;
+            }
         }
     }
-    out_move=best;
-    return bestScore;
+    prof_flush_thread();
+}
+
+// e.stop n'est pas remis à zéro ici : l'appelant le fait avant de lancer
+// la recherche, pour qu'un "stop" arrivé entre-temps ne soit pas perdu
+inline int search_best_move(Engine &e,Position &p,const SearchLimits &lim,int &out_move){
+    e.start=std::chrono::steady_clock::now();
+    if(lim.clock_ms > 0){
+        int soft, hard;
+        time_allocate(lim, soft, hard);
+        set_time_budget(e, soft, hard);
+    }else{
+        set_search_time(e, lim.time_ms);
+    }
+    e.node_limit=lim.nodes;
+    int max_depth=std::clamp(lim.depth, 1, MAX_PLY);
+    e.last = SearchReport();
+    e.lines.clear();
+    e.multipv = std::max(lim.multipv, 1);
+    if(e.pool.empty()) set_threads(e, 1);
+    if(!e.tt->buckets) tt_resize(*e.tt, TT_DEFAULT_MB);
+    if(e.ages_tt) tt_new_search(*e.tt);
+
+    // si aucune histoire, on initialise avec la position courante
+    if(e.history_len == 0){
+        e.history_len = 1;
+        e.history[0] = p.key;
+    }
+
+    int maxHist = e.history_len;
+    int base_ply = maxHist - 1;
+
+    // finale présente dans les tables : coup DTZ joué directement
+    int tbMove = 0, wdl = 0;
+    if(tb_can_probe(p) && syzygy_probe_root(p, tbMove, wdl)){
+        for(auto &tp : e.pool){
+            tp->nodes = 0;
+            tp->stats = SearchStats();
+            tp->completed_depth = 0;
+        }
+        SearchReport &r = e.last;
+        r.depth = 1;
+        r.score = tb_score(wdl, base_ply);
+        r.pv.assign(1, tbMove);
+        r.stats.tb_hits = 1;
+        e.lines.assign(1, r);
+        if(e.reporter) e.reporter(r, e.reporter_ctx);
+        out_move = tbMove;
+        return r.score;
+    }
+
+    // reset heuristiques + copie de l'historique, pour chaque thread
+    for(auto &tp : e.pool){
+        SearchThread &t = *tp;
+        for(SearchStack &ss : t.stack){
+            ss.killers[0] = ss.killers[1] = 0;
+        }
+        for(int c=0;c<2;c++)
+            for(int f=0;f<64;f++)
+                for(int to=0;to<64;to++)
+                    t.history_heur[c][f][to] = 0;
+        for(int i=0;i<maxHist;i++){
+            t.rep_history[i] = e.history[i];
+        }
+        t.nodes = 0;
+        t.stats = SearchStats();
+        t.pv_len[0] = 0;
+        t.best_move = 0;
+        t.best_score = -INF;
+        t.completed_depth = 0;
+    }
+
+    std::vector<std::thread> helpers;
+    for(size_t i=1;i<e.pool.size();i++)
+        helpers.emplace_back(iterative_deepening, std::ref(*e.pool[i]), p, max_depth, base_ply);
+    iterative_deepening(*e.pool[0], p, max_depth, base_ply);
+    e.stop=true;
+    for(auto &th : helpers) th.join();
+    prof_report(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - e.start).count());
+
+    // coup du thread allé le plus loin (le principal à égalité)
+    const SearchThread *best = e.pool[0].get();
+    for(auto &tp : e.pool){
+        if(tp->best_move && tp->completed_depth > best->completed_depth)
+            best = tp.get();
+    }
+    out_move=best->best_move;
+    return best->best_score;
+}
+
+// moteur principal : TT globale, historique = game_history
+inline int search_best_move(Position &p,const SearchLimits &lim,int &out_move){
+    // si aucune histoire, on initialise avec la position courante
+    if(game_ply == 0){
+        game_ply = 1;
+        game_history[0] = p.key;
+    }
+    main_engine.tt = &TT;
+    set_history(main_engine, game_history, game_ply);
+    return search_best_move(main_engine, p, lim, out_move);
+}
+
+inline int search_best_move(Position &p,int time_ms,int max_depth,int &out_move){
+    main_engine.stop=false;
+    SearchLimits lim;
+    lim.time_ms = time_ms;
+    lim.depth   = max_depth;
+    return search_best_move(p, lim, out_move);
 }
 
 // --- Helper pour afficher un coup "e2e4", "e7e8q", etc. ---
@@ -1401,4 +2698,62 @@ inline std::string move_to_str(int m){
     return s;
 }
 
+// --- Lecture d'un coup "e2e4" / "e7e8q" (coups légaux uniquement) ---
+inline int parse_move(const Position &p,const std::string &str){
+    int moves[256];
+    int n = generate_legal_moves(p, moves);
+    for(int i=0;i<n;i++)
+        if(move_to_str(moves[i]) == str) return moves[i];
+    return 0;
+}
+
+// --- Notation algébrique "Nbd7", "exd5", "e8=Q+", "O-O" (PGN) ---
+inline std::string move_to_san(const Position &p,int m){
+    int from = move_from(m), to = move_to(m);
+    int t = piece_type(p.board[from]);
+    std::string s;
+
+    if(m & MF_KSCASTLE) s = "O-O";
+    else if(m & MF_QSCASTLE) s = "O-O-O";
+    else{
+        int moves[256];
+        int n = generate_legal_moves(p, moves);
+        if(t != PAWN){
+            s += "PNBRQK"[t];
+            // levée d'ambiguïté : colonne, sinon rangée, sinon les deux
+            bool other = false, sameFile = false, sameRank = false;
+            for(int i=0;i<n;i++){
+                int o = moves[i], of = move_from(o);
+                if(of == from || move_to(o) != to || piece_type(p.board[of]) != t) continue;
+                other = true;
+                if(file_of(of) == file_of(from)) sameFile = true;
+                if(rank_of(of) == rank_of(from)) sameRank = true;
+            }
+            if(other){
+                if(!sameFile)      s += char('a' + file_of(from));
+                else if(!sameRank) s += char('1' + rank_of(from));
+                else { s += char('a' + file_of(from)); s += char('1' + rank_of(from)); }
+            }
+        }else if(move_is_capture(m)){
+            s += char('a' + file_of(from));
+        }
+        if(move_is_capture(m)) s += 'x';
+        s += char('a' + file_of(to));
+        s += char('1' + rank_of(to));
+        if(move_is_promo(m)){
+            s += '=';
+            s += "PNBRQK"[move_promo(m)];
+        }
+    }
+
+    Position q = p;
+    Undo u;
+    make_move(q, m, u);
+    if(in_check(q, q.stm)){
+        int replies[256];
+        s += generate_legal_moves(q, replies) ? '+' : '#';
+    }
+    return s;
+}
+
 } // namespace cechess
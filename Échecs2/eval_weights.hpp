@@ -0,0 +1,252 @@
+#pragma once
+
+namespace cechess {
+
+// =========================
+// Poids de l'évaluation classique
+// =========================
+// Centipions ; chaque poids a une valeur de milieu de partie (MG) et de
+// finale (EG), interpolées selon la phase. Fichier réécrit par tuner.cpp
+// (--out) : modifier les valeurs à la main reste possible, mais la mise en
+// page est celle du générateur.
+
+// matériel : P N B R Q K
+static constexpr int MAT_MG[6] = { 100, 320, 330, 500, 900,   0};
+static constexpr int MAT_EG[6] = { 100, 320, 330, 500, 900,   0};
+
+// PST vues des blancs : index = case (a1 = 0), 63-case pour les noirs
+static constexpr int PST_MG[6][64] = {
+// PAWN
+{
+  0,  0,  0,  0,  0,  0,  0,  0,
+ 50, 50, 50, 50, 50, 50, 50, 50,
+ 10, 10, 20, 30, 30, 20, 10, 10,
+  5,  5, 10, 27, 27, 10,  5,  5,
+  0,  0,  0, 25, 25,  0,  0,  0,
+  5, -5,-10,  0,  0,-10, -5,  5,
+  5, 10, 10,-25,-25, 10, 10,  5,
+  0,  0,  0,  0,  0,  0,  0,  0
+},
+// KNIGHT
+{
+-50,-40,-30,-30,-30,-30,-40,-50,
+-40,-20,  0,  5,  5,  0,-20,-40,
+-30,  5, 10, 15, 15, 10,  5,-30,
+-30,  0, 15, 20, 20, 15,  0,-30,
+-30,  5, 15, 20, 20, 15,  5,-30,
+-30,  0, 10, 15, 15, 10,  0,-30,
+-40,-20,  0,  0,  0,  0,-20,-40,
+-50,-40,-30,-30,-30,-30,-40,-50
+},
+// BISHOP
+{
+-20,-10,-10,-10,-10,-10,-10,-20,
+-10,  5,  0,  0,  0,  0,  5,-10,
+-10, 10, 10, 10, 10, 10, 10,-10,
+-10,  0, 10, 10, 10, 10,  0,-10,
+-10,  5,  5, 10, 10,  5,  5,-10,
+-10,  0,  5, 10, 10,  5,  0,-10,
+-10,  0,  0,  0,  0,  0,  0,-10,
+-20,-10,-10,-10,-10,-10,-10,-20
+},
+// ROOK
+{
+  0,  0,  5, 10, 10,  5,  0,  0,
+ -5,  0,  0,  0,  0,  0,  0, -5,
+ -5,  0,  0,  0,  0,  0,  0, -5,
+ -5,  0,  0,  0,  0,  0,  0, -5,
+ -5,  0,  0,  0,  0,  0,  0, -5,
+ -5,  0,  0,  0,  0,  0,  0, -5,
+  5, 10, 10, 10, 10, 10, 10,  5,
+  0,  0,  0,  0,  0,  0,  0,  0
+},
+// QUEEN
+{
+-20,-10,-10, -5, -5,-10,-10,-20,
+-10,  0,  5,  0,  0,  0,  0,-10,
+-10,  5,  5,  5,  5,  5,  0,-10,
+ -5,  0,  5,  5,  5,  5,  0, -5,
+  0,  0,  5,  5,  5,  5,  0, -5,
+-10,  0,  5,  5,  5,  5,  0,-10,
+-10,  0,  0,  0,  0,  0,  0,-10,
+-20,-10,-10, -5, -5,-10,-10,-20
+},
+// KING
+{
+-30,-40,-40,-50,-50,-40,-40,-30,
+-30,-40,-40,-50,-50,-40,-40,-30,
+-30,-40,-40,-50,-50,-40,-40,-30,
+-30,-40,-40,-50,-50,-40,-40,-30,
+-20,-30,-30,-40,-40,-30,-30,-20,
+-10,-20,-20,-20,-20,-20,-20,-10,
+ 20, 20,  0,  0,  0,  0, 20, 20,
+ 20, 30, 10,  0,  0, 10, 30, 20
+}
+};
+
+static constexpr int PST_EG[6][64] = {
+// PAWN
+{
+  0,  0,  0,  0,  0,  0,  0,  0,
+ 10, 10, 10, 10, 10, 10, 10, 10,
+  0,  0,  5, 10, 10,  5,  0,  0,
+  0,  0, 10, 20, 20, 10,  0,  0,
+  0,  0, 10, 25, 25, 10,  0,  0,
+  0,  0,  5, 10, 10,  5,  0,  0,
+  0,  0,  0,-10,-10,  0,  0,  0,
+  0,  0,  0,  0,  0,  0,  0,  0
+},
+// KNIGHT
+{
+-40,-30,-20,-20,-20,-20,-30,-40,
+-30,-10,  0,  0,  0,  0,-10,-30,
+-20,  0, 10, 15, 15, 10,  0,-20,
+-20,  5, 15, 20, 20, 15,  5,-20,
+-20,  0, 15, 20, 20, 15,  0,-20,
+-20,  5, 10, 15, 15, 10,  5,-20,
+-30,-10,  0,  0,  0,  0,-10,-30,
+-40,-30,-20,-20,-20,-20,-30,-40
+},
+// BISHOP
+{
+-20,-10,-10,-10,-10,-10,-10,-20,
+-10,  0,  0,  0,  0,  0,  0,-10,
+-10,  0,  5, 10, 10,  5,  0,-10,
+-10,  5, 10, 15, 15, 10,  5,-10,
+-10,  0, 10, 15, 15, 10,  0,-10,
+-10,  5,  5, 10, 10,  5,  5,-10,
+-10,  0,  0,  0,  0,  0,  0,-10,
+-20,-10,-10,-10,-10,-10,-10,-20
+},
+// ROOK
+{
+  0,  0,  5, 15, 15,  5,  0,  0,
+ -5,  0,  0,  5,  5,  0,  0, -5,
+ -5,  0,  0,  5,  5,  0,  0, -5,
+ -5,  0,  0,  5,  5,  0,  0, -5,
+ -5,  0,  0,  5,  5,  0,  0, -5,
+ -5,  0,  0,  5,  5,  0,  0, -5,
+  5, 10, 10, 15, 15, 10, 10,  5,
+  0,  0,  0,  5,  5,  0,  0,  0
+},
+// QUEEN
+{
+-10,-10,-10, -5, -5,-10,-10,-10,
+-10,  0,  0,  0,  0,  0,  0,-10,
+-10,  0,  5,  5,  5,  5,  0,-10,
+ -5,  0,  5,  5,  5,  5,  0, -5,
+  0,  0,  5,  5,  5,  5,  0, -5,
+-10,  0,  5,  5,  5,  5,  0,-10,
+-10,  0,  0,  0,  0,  0,  0,-10,
+-10,-10,-10, -5, -5,-10,-10,-10
+},
+// KING
+{
+-50,-40,-30,-20,-20,-30,-40,-50,
+-30,-20,-10,  0,  0,-10,-20,-30,
+-30,-10, 20, 30, 30, 20,-10,-30,
+-30,-10, 30, 40, 40, 30,-10,-30,
+-30,-10, 30, 40, 40, 30,-10,-30,
+-30,-10, 20, 30, 30, 20,-10,-30,
+-30,-30,  0,  0,  0,  0,-30,-30,
+-50,-40,-30,-20,-20,-30,-40,-50
+}
+};
+
+// termes de eval_pawns / eval_pieces : poids x nombre d'occurrences
+enum EvalTerm {
+    PAWN_CENTER,
+    PAWN_DOUBLED,
+    PAWN_ISOLATED,
+    PAWN_BACKWARD,
+    PASSED_RANK_1,
+    PASSED_RANK_2,
+    PASSED_RANK_3,
+    PASSED_RANK_4,
+    PASSED_RANK_5,
+    PASSED_RANK_6,
+    PASSED_RANK_7,
+    PASSED_RANK_8,
+    PASSED_PROTECTED,
+    PASSED_CONNECTED,
+    MINOR_CENTER,
+    QUEEN_CENTER,
+    MINOR_UNDEVELOPED,
+    MOB_KNIGHT,
+    MOB_BISHOP,
+    MOB_ROOK,
+    MOB_QUEEN,
+    ROOK_OPEN_FILE,
+    ROOK_SEMI_OPEN,
+    KING_CASTLED,
+    KING_UNCASTLED,
+    KING_SHIELD,
+    KING_NO_SHIELD,
+    KING_ACTIVE,
+    EVAL_TERM_NB
+};
+
+static constexpr const char *EVAL_TERM_NAMES[EVAL_TERM_NB] = {
+    "PAWN_CENTER",
+    "PAWN_DOUBLED",
+    "PAWN_ISOLATED",
+    "PAWN_BACKWARD",
+    "PASSED_RANK_1",
+    "PASSED_RANK_2",
+    "PASSED_RANK_3",
+    "PASSED_RANK_4",
+    "PASSED_RANK_5",
+    "PASSED_RANK_6",
+    "PASSED_RANK_7",
+    "PASSED_RANK_8",
+    "PASSED_PROTECTED",
+    "PASSED_CONNECTED",
+    "MINOR_CENTER",
+    "QUEEN_CENTER",
+    "MINOR_UNDEVELOPED",
+    "MOB_KNIGHT",
+    "MOB_BISHOP",
+    "MOB_ROOK",
+    "MOB_QUEEN",
+    "ROOK_OPEN_FILE",
+    "ROOK_SEMI_OPEN",
+    "KING_CASTLED",
+    "KING_UNCASTLED",
+    "KING_SHIELD",
+    "KING_NO_SHIELD",
+    "KING_ACTIVE"
+};
+
+// { MG, EG }
+static constexpr int EVAL_W[EVAL_TERM_NB][2] = {
+    {  10,   5}, // PAWN_CENTER
+    { -10,  -5}, // PAWN_DOUBLED
+    { -15, -10}, // PAWN_ISOLATED
+    { -10, -10}, // PAWN_BACKWARD
+    {   0,   0}, // PASSED_RANK_1
+    {  10,  20}, // PASSED_RANK_2
+    {  20,  40}, // PASSED_RANK_3
+    {  30,  60}, // PASSED_RANK_4
+    {  40,  80}, // PASSED_RANK_5
+    {  50, 100}, // PASSED_RANK_6
+    {  60, 120}, // PASSED_RANK_7
+    {  70, 140}, // PASSED_RANK_8
+    {  15,  25}, // PASSED_PROTECTED
+    {  10,  15}, // PASSED_CONNECTED
+    {   8,   5}, // MINOR_CENTER
+    {   4,   0}, // QUEEN_CENTER
+    { -10,   0}, // MINOR_UNDEVELOPED
+    {   2,   0}, // MOB_KNIGHT
+    {   2,   0}, // MOB_BISHOP
+    {   1,   0}, // MOB_ROOK
+    {   1,   1}, // MOB_QUEEN
+    {  15,  10}, // ROOK_OPEN_FILE
+    {   8,   5}, // ROOK_SEMI_OPEN
+    {  30,   0}, // KING_CASTLED
+    { -30,   0}, // KING_UNCASTLED
+    {   8,   0}, // KING_SHIELD
+    { -20,   0}, // KING_NO_SHIELD
+    {   0,   5}  // KING_ACTIVE
+};
+
+} // namespace cechess
@@ -4,7 +4,11 @@
 #include <cctype>
 #include <vector>
 #include <limits>
+#include <cstdlib>
+#include <chrono>
 #include "engine2.hpp"
+#include "book.hpp"
+#include "uci.hpp"
 
 using namespace cechess;
 
@@ -61,29 +65,6 @@ void print_board(const Position &p) {
     std::cout << (p.stm == WHITE ? "Side to move: White\n" : "Side to move: Black\n");
 }
 
-// =========================
-// Helpers légalité (coup légal vs pseudo-coup)
-// =========================
-
-static bool is_legal_move(Position &pos, int m) {
-    Undo u;
-    make_move(pos, m, u);
-    Color justPlayed = (Color)(pos.stm ^ 1);
-    bool ok = !in_check(pos, justPlayed);
-    unmake_move(pos, u);
-    return ok;
-}
-
-static int generate_legal_moves(Position &pos, int *out_moves) {
-    int pseudo[256];
-    int n = generate_moves(pos, pseudo, false);
-    int k = 0;
-    for (int i = 0; i < n; ++i) {
-        if (is_legal_move(pos, pseudo[i])) out_moves[k++] = pseudo[i];
-    }
-    return k;
-}
-
 // =========================
 // Nulle 3 répétitions (sur historique réel game_history)
 // =========================
@@ -149,7 +130,7 @@ static int parse_coord_move(Position &p, const std::string &input) {
     }
 
     int moves[256];
-    int n = generate_moves(p, moves, false); // pseudo-coups
+    int n = generate_legal_moves(p, moves);
     for (int i = 0; i < n; i++) {
         int m = moves[i];
         if (move_from(m) == from && move_to(m) == to) {
@@ -202,9 +183,22 @@ enum PlayerKind { HUMAN = 0, ENGINE_PLAYER = 1 };
 struct GameConfig {
     PlayerKind white;
     PlayerKind black;
-    int engineTimeMs; // temps par défaut
+    int clockMs;      // pendule de l'engine (par camp)
+    int incMs;        // incrément par coup
+    int threads;      // threads de recherche (Lazy SMP)
+    int hashMb;       // taille de la table de transposition
+    std::string bookPath; // livre Polyglot (.bin), vide = pas de livre
+    bool uci = false; // "uci" reçu à la place du choix : une GUI nous pilote
 };
 
+// "m:ss.d"
+static std::string format_clock(int ms) {
+    if (ms < 0) ms = 0;
+    std::ostringstream os;
+    os << ms / 60000 << ":" << (ms / 10000) % 6 << (ms / 1000) % 10 << "." << (ms / 100) % 10;
+    return os.str();
+}
+
 static GameConfig setup_game() {
     GameConfig cfg;
     std::cout << "===== C++ Chess Engine =====\n";
@@ -213,13 +207,16 @@ static GameConfig setup_game() {
     std::cout << "  2) Engine (White) vs Human (Black)\n";
     std::cout << "  3) Human vs Human\n";
     std::cout << "  4) Engine vs Engine\n";
-    std::cout << "Enter choice [1-4]: ";
-
-    int choice = 1;
-    if (!(std::cin >> choice)) {
-        std::cin.clear();
+    std::cout << "Enter choice [1-4] (or 'uci'): ";
+
+    std::string first;
+    std::getline(std::cin, first);
+    trim(first);
+    if (first == "uci") {
+        cfg.uci = true;
+        return cfg;
     }
-    std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+    int choice = std::atoi(first.c_str());
 
     switch (choice) {
         case 2: cfg.white = ENGINE_PLAYER; cfg.black = HUMAN;         break;
@@ -232,18 +229,53 @@ static GameConfig setup_game() {
             break;
     }
 
-    std::cout << "Engine time per move in ms (default 2000): ";
-    if (!(std::cin >> cfg.engineTimeMs)) {
-        cfg.engineTimeMs = 2000;
+    std::cout << "Engine clock in seconds (default 300): ";
+    double clockSec = 300;
+    if (!(std::cin >> clockSec)) {
+        clockSec = 300;
         std::cin.clear();
     }
     std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
-    if (cfg.engineTimeMs <= 0) cfg.engineTimeMs = 2000;
+    if (clockSec <= 0) clockSec = 300;
+    cfg.clockMs = (int)(clockSec * 1000);
+
+    std::cout << "Increment per move in seconds (default 2): ";
+    double incSec = 2;
+    if (!(std::cin >> incSec)) {
+        incSec = 2;
+        std::cin.clear();
+    }
+    std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+    if (incSec < 0) incSec = 0;
+    cfg.incMs = (int)(incSec * 1000);
+
+    std::cout << "Search threads (default 1): ";
+    if (!(std::cin >> cfg.threads)) {
+        cfg.threads = 1;
+        std::cin.clear();
+    }
+    std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+    if (cfg.threads <= 0) cfg.threads = 1;
+
+    std::cout << "Hash size in MB (default 16): ";
+    if (!(std::cin >> cfg.hashMb)) {
+        cfg.hashMb = 16;
+        std::cin.clear();
+    }
+    std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+    if (cfg.hashMb <= 0) cfg.hashMb = 16;
+
+    std::cout << "Opening book .bin (empty = none): ";
+    std::getline(std::cin, cfg.bookPath);
+    trim(cfg.bookPath);
 
     std::cout << "Configuration:\n";
     std::cout << "  White: " << (cfg.white == HUMAN ? "Human" : "Engine") << "\n";
     std::cout << "  Black: " << (cfg.black == HUMAN ? "Human" : "Engine") << "\n";
-    std::cout << "  Engine time: " << cfg.engineTimeMs << " ms\n\n";
+    std::cout << "  Engine clock: " << format_clock(cfg.clockMs) << " + " << cfg.incMs / 1000.0 << " s\n";
+    std::cout << "  Threads: " << cfg.threads << "\n";
+    std::cout << "  Hash: " << cfg.hashMb << " MB\n";
+    std::cout << "  Book: " << (cfg.bookPath.empty() ? "none" : cfg.bookPath) << "\n\n";
 
     return cfg;
 }
@@ -257,19 +289,31 @@ static bool is_human_turn(const Position &p, const GameConfig &cfg) {
 // Main loop
 // =========================
 
-int main() {
-    init_all();
+int main(int argc, char **argv) {
+    // "./cechess uci" : directement en mode UCI, sans menu
+    if (argc > 1 && tolower_str(argv[1]) == "uci") return uci_loop();
 
     Position pos;
     start_new_game(pos); // initialise game_history/game_ply
 
     GameConfig cfg = setup_game();
+    if (cfg.uci) return uci_loop(true);
+    set_threads(cfg.threads);
+    tt_resize(cfg.hashMb);
+    if (!cfg.bookPath.empty() && !book_open(book, cfg.bookPath))
+        std::cout << "Cannot open book " << cfg.bookPath << ", playing without.\n";
+    else if (!cfg.bookPath.empty() && !book_has_startpos(book))
+        std::cout << "Book " << cfg.bookPath << " has no entry for the start position with the internal keys"
+                     " (Polyglot books need the Random64 table, UCI option BookKeys).\n";
 
     std::vector<int> move_history;
 
     // override one-shot pour le prochain coup engine
     int next_engine_time_ms = -1;
 
+    // pendule de chaque camp joué par l'engine
+    int engine_clock_ms[2] = { cfg.clockMs, cfg.clockMs };
+
     while (true) {
         print_board(pos);
 
@@ -311,13 +355,38 @@ int main() {
         // Tour de l'engine
         // =========================
         if (!humanTurn) {
-            int time_ms = (next_engine_time_ms > 0 ? next_engine_time_ms : cfg.engineTimeMs);
-            next_engine_time_ms = -1; // one-shot consommé
+            int &clock = engine_clock_ms[pos.stm];
+
+            // livre d'ouvertures : coup joué sans recherche (l'override 'modify' force une recherche)
+            if (next_engine_time_ms <= 0) {
+                if (int bm = book_probe(pos)) {
+                    clock += cfg.incMs;
+                    apply_game_move(pos, bm);
+                    move_history.push_back(bm);
+                    std::cout << "[Engine] plays: " << move_to_str(bm)
+                              << " (book, clock " << format_clock(clock) << ")\n\n";
+                    continue;
+                }
+            }
 
-            std::cout << "[Engine] thinking (" << time_ms << " ms)...\n";
+            SearchLimits lim;
+            if (next_engine_time_ms > 0) {
+                lim.time_ms = next_engine_time_ms;
+                std::cout << "[Engine] thinking (" << lim.time_ms << " ms)...\n";
+            } else {
+                lim.clock_ms = clock;
+                lim.inc_ms = cfg.incMs;
+                std::cout << "[Engine] thinking (clock " << format_clock(clock) << ")...\n";
+            }
+            next_engine_time_ms = -1; // one-shot consommé
 
+            auto t0 = std::chrono::steady_clock::now();
             int bestMove = 0;
-            int score = search_best_move(pos, time_ms, 64, bestMove);
+            main_engine.stop = false;
+            int score = search_best_move(pos, lim, bestMove);
+            int spent = (int)std::chrono::duration_cast<std::chrono::milliseconds>(
+                            std::chrono::steady_clock::now() - t0).count();
+            clock += cfg.incMs - spent;
 
             if (!bestMove) {
                 bestMove = legal_moves[0]; // fallback
@@ -329,8 +398,14 @@ int main() {
 
             std::cout << "[Engine] plays: " << ms
                       << " (score " << score
+                      << ", depth " << last_report().depth
                       << ", nodes " << get_nodes()
+                      << ", " << spent << " ms, clock " << format_clock(clock)
                       << ")\n\n";
+            if (clock <= 0) {
+                std::cout << "[Engine] lost on time: " << (pos.stm == WHITE ? "White" : "Black") << " wins.\n";
+                break;
+            }
             continue;
         }
 
@@ -355,8 +430,8 @@ int main() {
             continue;
 
         } else if (cmd == "modify" || cmd == "m" || cmd == "time" || cmd == "t") {
-            std::cout << "Engine time (ms) for NEXT engine move only (current default "
-                      << cfg.engineTimeMs << "). Enter ms (or empty to cancel): ";
+            std::cout << "Engine time (ms) for NEXT engine move only (default: from clock, "
+                      << format_clock(engine_clock_ms[pos.stm ^ 1]) << " left). Enter ms (or empty to cancel): ";
             std::string v;
             std::getline(std::cin, v);
             trim(v);
@@ -411,11 +486,6 @@ int main() {
                 continue;
             }
 
-            if (!is_legal_move(pos, m)) {
-                std::cout << "Move leaves king in check (illegal).\n";
-                continue;
-            }
-
             apply_game_move(pos, m);
             move_history.push_back(m);
 
@@ -0,0 +1,111 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <cstdlib>
+#include "engine2.hpp"
+#include "book.hpp"
+
+using namespace cechess;
+
+// =========================
+// Construction d'un livre Polyglot
+// =========================
+// Entrée : une partie par ligne, coups en notation UCI depuis la position
+// initiale ("e2e4 e7e5 g1f3 ..."). La lecture d'une partie s'arrête au
+// premier jeton qui n'est pas un coup légal (résultat, commentaire...).
+// Poids = nombre de parties où le coup a été joué (plafonné à 65535).
+
+struct BookOptions {
+    int plies = BOOK_DEFAULT_PLY;  // demi-coups enregistrés par partie
+    int minCount = 1;              // coups joués moins souvent : ignorés
+    std::string in, out, keys;
+};
+
+static void usage() {
+    std::cout << "Usage: makebook <games.txt> --out book.bin [--plies N] [--min N] [--keys random64.txt]\n"
+                 "  une partie par ligne, coups UCI depuis la position initiale\n"
+                 "  --keys : table Random64 Polyglot (781 valeurs hex), sinon clés internes\n";
+}
+
+static void write_be(std::ostream &out, U64 v, int bytes) {
+    for (int i = bytes - 1; i >= 0; --i) out.put((char)((v >> (8 * i)) & 0xFF));
+}
+
+int main(int argc, char **argv) {
+    BookOptions opt;
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        bool hasArg = i + 1 < argc;
+        if      (a == "--out"   && hasArg) opt.out = argv[++i];
+        else if (a == "--plies" && hasArg) opt.plies = std::atoi(argv[++i]);
+        else if (a == "--min"   && hasArg) opt.minCount = std::atoi(argv[++i]);
+        else if (a == "--keys"  && hasArg) opt.keys = argv[++i];
+        else if (a == "-h" || a == "--help") { usage(); return 0; }
+        else if (opt.in.empty() && a[0] != '-') opt.in = a;
+        else { usage(); return 1; }
+    }
+    if (opt.in.empty() || opt.out.empty()) { usage(); return 1; }
+    if (!opt.keys.empty() && !book_load_keys(opt.keys)) {
+        std::cerr << "Cannot read keys " << opt.keys << " (781 hex values of the Polyglot Random64 table expected)\n";
+        return 1;
+    }
+
+    std::ifstream in(opt.in);
+    if (!in) {
+        std::cerr << "Cannot open " << opt.in << "\n";
+        return 1;
+    }
+
+    // (clé, coup) -> nombre de parties
+    std::map<std::pair<U64, uint16_t>, U64> counts;
+    long long games = 0;
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        Position p;
+        set_startpos(p);
+        std::istringstream is(line);
+        std::string tok;
+        for (int ply = 0; ply < opt.plies && is >> tok; ++ply) {
+            int m = parse_move(p, tok);
+            if (!m) break;
+            counts[{poly_key(p), book_encode_move(m)}]++;
+            Undo u;
+            make_move(p, m, u);
+        }
+        ++games;
+    }
+
+    std::vector<BookEntry> entries;
+    for (const auto &kv : counts) {
+        if (kv.second < (U64)opt.minCount) continue;
+        BookEntry e;
+        e.key = kv.first.first;
+        e.move = kv.first.second;
+        e.weight = (uint16_t)std::min<U64>(kv.second, 65535);
+        entries.push_back(e);
+    }
+    // ordre Polyglot : clé croissante, puis poids décroissant
+    std::sort(entries.begin(), entries.end(), [](const BookEntry &a, const BookEntry &b) {
+        return a.key != b.key ? a.key < b.key : a.weight > b.weight;
+    });
+
+    std::ofstream out(opt.out, std::ios::binary);
+    if (!out) {
+        std::cerr << "Cannot write " << opt.out << "\n";
+        return 1;
+    }
+    for (const BookEntry &e : entries) {
+        write_be(out, e.key, 8);
+        write_be(out, e.move, 2);
+        write_be(out, e.weight, 2);
+        write_be(out, e.learn, 4);
+    }
+
+    std::cerr << "Games " << games << "  entries " << entries.size() << "\n";
+    return 0;
+}
@@ -0,0 +1,536 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <csignal>
+#include <poll.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/wait.h>
+#include "engine2.hpp"
+
+using namespace cechess;
+
+// =========================
+// Match entre deux moteurs UCI (SPRT, Elo, PGN)
+// =========================
+// Chaque worker fait tourner ses deux processus moteurs et joue des parties
+// jusqu'à épuisement ; chaque ouverture est jouée deux fois, couleurs
+// inversées. L'arbitrage (mat, pat, 50 coups, répétition, matériel
+// insuffisant, temps, coup illégal) est fait ici, avec ce moteur.
+// POSIX uniquement (fork/exec/pipe).
+
+struct EngineSpec {
+    std::string cmd;                                         // ex. "./cechess uci"
+    std::string name;
+    std::vector<std::pair<std::string, std::string>> options; // setoption name/value
+};
+
+struct MatchOptions {
+    EngineSpec eng[2];
+    int games = 100;             // arrondi au nombre pair supérieur
+    int concurrency = 1;
+    // cadence : nœuds fixes, temps fixe par coup, ou pendule + incrément
+    U64 nodes = 0;
+    int movetimeMs = 0;
+    int clockMs = 10000, incMs = 100;
+    int marginMs = 100;          // tolérance avant perte au temps
+    int maxPlies = 0;            // 0 = pas de limite ; sinon partie nulle par arbitrage
+    std::string openings, pgn;
+    // SPRT (désactivé si elo0 == elo1)
+    double elo0 = 0, elo1 = 0, alpha = 0.05, beta = 0.05;
+};
+
+// =========================
+// Processus UCI
+// =========================
+
+struct UciProcess {
+    pid_t pid = -1;
+    int to = -1, from = -1;      // stdin / stdout du moteur
+    std::string buf;
+
+    // Les workers lancent leurs moteurs en parallèle : les tubes sont O_CLOEXEC
+    // pour qu'aucun autre moteur n'en hérite (sinon la fin de flux n'arrive
+    // jamais), et l'enfant n'alloue rien entre fork et exec.
+    bool start(const std::string &cmd) {
+        int in[2], out[2];
+        if (pipe2(in, O_CLOEXEC)) return false;
+        if (pipe2(out, O_CLOEXEC)) { close(in[0]); close(in[1]); return false; }
+        std::string shellCmd = "exec " + cmd;
+        pid = fork();
+        if (pid < 0) {
+            close(in[0]); close(in[1]); close(out[0]); close(out[1]);
+            return false;
+        }
+        if (pid == 0) {
+            // dup2 retire O_CLOEXEC de la copie, sauf si le descripteur est déjà le bon
+            if (in[0] == 0) fcntl(0, F_SETFD, 0); else dup2(in[0], 0);
+            if (out[1] == 1) fcntl(1, F_SETFD, 0); else dup2(out[1], 1);
+            execl("/bin/sh", "sh", "-c", shellCmd.c_str(), (char*)nullptr);
+            _exit(127);
+        }
+        close(in[0]); close(out[1]);
+        to = in[1]; from = out[0];
+        buf.clear();
+        return true;
+    }
+
+    void send(const std::string &line) {
+        std::string l = line + "\n";
+        if (write(to, l.data(), l.size()) < 0) { /* moteur mort : détecté à la lecture */ }
+    }
+
+    // false si le délai expire ou si le moteur s'arrête
+    bool read_line(std::string &line, int timeoutMs) {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+        while (true) {
+            size_t nl = buf.find('\n');
+            if (nl != std::string::npos) {
+                line = buf.substr(0, nl);
+                if (!line.empty() && line.back() == '\r') line.pop_back();
+                buf.erase(0, nl + 1);
+                return true;
+            }
+            int left = (int)std::chrono::duration_cast<std::chrono::milliseconds>(
+                           deadline - std::chrono::steady_clock::now()).count();
+            if (left <= 0) return false;
+            pollfd pfd{from, POLLIN, 0};
+            if (poll(&pfd, 1, left) <= 0) continue;
+            char tmp[4096];
+            ssize_t n = read(from, tmp, sizeof(tmp));
+            if (n <= 0) return false;
+            buf.append(tmp, (size_t)n);
+        }
+    }
+
+    // attend une ligne commençant par 'prefix'
+    bool wait_for(const std::string &prefix, std::string &line, int timeoutMs) {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+        while (true) {
+            int left = (int)std::chrono::duration_cast<std::chrono::milliseconds>(
+                           deadline - std::chrono::steady_clock::now()).count();
+            if (left <= 0 || !read_line(line, left)) return false;
+            if (line.compare(0, prefix.size(), prefix) == 0) return true;
+        }
+    }
+
+    void stop() {
+        if (pid <= 0) return;
+        send("quit");
+        close(to); close(from);
+        int status;
+        for (int i = 0; i < 50 && waitpid(pid, &status, WNOHANG) == 0; ++i)
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        if (waitpid(pid, &status, WNOHANG) == 0) { kill(pid, SIGKILL); waitpid(pid, &status, 0); }
+        pid = -1;
+    }
+};
+
+static bool engine_init(UciProcess &e, const EngineSpec &spec) {
+    if (!e.start(spec.cmd)) return false;
+    std::string line;
+    e.send("uci");
+    if (!e.wait_for("uciok", line, 10000)) return false;
+    for (const auto &o : spec.options) e.send("setoption name " + o.first + " value " + o.second);
+    e.send("isready");
+    return e.wait_for("readyok", line, 30000);
+}
+
+// =========================
+// Ouvertures
+// =========================
+// FEN/EPD (une position par ligne) ou coups UCI depuis la position initiale.
+
+struct Opening {
+    std::string fen;             // vide = position initiale
+    std::vector<std::string> moves;
+};
+
+static std::vector<Opening> load_openings(const std::string &path) {
+    std::vector<Opening> out;
+    std::ifstream in(path);
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        Opening o;
+        if (line.find('/') != std::string::npos) {
+            // EPD : on garde les 4 premiers champs (+ compteurs s'ils sont là)
+            std::istringstream is(line);
+            std::string tok, fen;
+            for (int i = 0; i < 6 && is >> tok && tok.find(';') == std::string::npos; ++i) {
+                if (i >= 4 && !std::isdigit((unsigned char)tok[0])) break;
+                fen += (fen.empty() ? "" : " ") + tok;
+            }
+            Position p;
+            if (!set_fen(p, fen)) continue;
+            o.fen = fen;
+        } else {
+            std::istringstream is(line);
+            std::string tok;
+            Position p;
+            set_startpos(p);
+            while (is >> tok) {
+                int m = parse_move(p, tok);
+                if (!m) break;
+                Undo u;
+                make_move(p, m, u);
+                o.moves.push_back(tok);
+            }
+        }
+        out.push_back(o);
+    }
+    return out;
+}
+
+// =========================
+// Partie
+// =========================
+
+enum GameResult { WHITE_WINS, BLACK_WINS, DRAWN };
+
+struct GameRecord {
+    Opening opening;
+    int white = 0;               // index du moteur qui a les blancs
+    GameResult result = DRAWN;
+    std::string termination;
+    std::vector<std::string> san;
+};
+
+static std::string go_command(const MatchOptions &opt, const int clock[2]) {
+    std::ostringstream os;
+    os << "go";
+    if (opt.nodes)           os << " nodes " << opt.nodes;
+    else if (opt.movetimeMs) os << " movetime " << opt.movetimeMs;
+    else os << " wtime " << std::max(clock[0], 1) << " btime " << std::max(clock[1], 1)
+            << " winc " << opt.incMs << " binc " << opt.incMs;
+    return os.str();
+}
+
+// joue une partie ; eng[i] = moteur de la spec i (0 : premier moteur)
+static bool play_game(const MatchOptions &opt, UciProcess eng[2], GameRecord &g) {
+    Position p;
+    std::string posCmd = "position ";
+    if (g.opening.fen.empty()) { set_startpos(p); posCmd += "startpos"; }
+    else { set_fen(p, g.opening.fen); posCmd += "fen " + g.opening.fen; }
+
+    std::vector<U64> keys{p.key};
+    std::vector<std::string> played;
+    auto play = [&](int m) {
+        g.san.push_back(move_to_san(p, m));
+        played.push_back(move_to_str(m));
+        Undo u;
+        make_move(p, m, u);
+        keys.push_back(p.key);
+    };
+    for (const std::string &mv : g.opening.moves) play(parse_move(p, mv));
+
+    std::string line;
+    for (int i = 0; i < 2; ++i) {
+        eng[i].send("ucinewgame");
+        eng[i].send("isready");
+        if (!eng[i].wait_for("readyok", line, 30000)) return false;
+    }
+
+    int clock[2] = {opt.clockMs, opt.clockMs};
+    auto finish = [&](GameResult r, const char *why) { g.result = r; g.termination = why; return true; };
+    auto loses = [&](Color c, const char *why) { return finish(c == WHITE ? BLACK_WINS : WHITE_WINS, why); };
+
+    while (true) {
+        int moves[256];
+        if (generate_legal_moves(p, moves) == 0)
+            return in_check(p, p.stm) ? loses(p.stm, "checkmate") : finish(DRAWN, "stalemate");
+        if (p.halfmove >= 100) return finish(DRAWN, "fifty moves");
+        int reps = 0;
+        for (size_t i = keys.size(); i-- > 0 && keys.size() - 1 - i <= (size_t)p.halfmove; )
+            if (keys[i] == p.key) ++reps;
+        if (reps >= 3) return finish(DRAWN, "repetition");
+        if (insufficient_material(p)) return finish(DRAWN, "insufficient material");
+        if (opt.maxPlies && (int)g.san.size() >= opt.maxPlies) return finish(DRAWN, "max plies");
+
+        Color stm = p.stm;
+        UciProcess &e = eng[stm == WHITE ? g.white : 1 - g.white];
+        std::string cmd = posCmd;
+        if (!played.empty()) {
+            cmd += " moves";
+            for (const std::string &mv : played) cmd += " " + mv;
+        }
+        e.send(cmd);
+        e.send(go_command(opt, clock));
+
+        int budget = opt.nodes ? 600000 : opt.movetimeMs ? opt.movetimeMs + 5000 : clock[stm] + opt.marginMs;
+        auto t0 = std::chrono::steady_clock::now();
+        bool ok = e.wait_for("bestmove", line, budget);
+        int spent = (int)std::chrono::duration_cast<std::chrono::milliseconds>(
+                        std::chrono::steady_clock::now() - t0).count();
+        if (!ok) return loses(stm, e.pid > 0 && spent >= budget ? "time forfeit" : "engine stopped");
+
+        if (!opt.nodes && !opt.movetimeMs) {
+            clock[stm] -= spent;
+            if (clock[stm] < -opt.marginMs) return loses(stm, "time forfeit");
+            clock[stm] += opt.incMs;
+        }
+
+        std::istringstream is(line);
+        std::string tok, mv;
+        is >> tok >> mv;
+        int m = parse_move(p, mv);
+        if (!m) return loses(stm, "illegal move");
+        play(m);
+    }
+}
+
+// =========================
+// Statistiques (point de vue du premier moteur)
+// =========================
+
+struct Score {
+    int wins = 0, losses = 0, draws = 0;
+    int games() const { return wins + losses + draws; }
+};
+
+static double elo_of(double s) {
+    s = std::clamp(s, 1e-6, 1 - 1e-6);
+    return 400.0 * std::log10(s / (1.0 - s));
+}
+static double score_of(double elo) { return 1.0 / (1.0 + std::pow(10.0, -elo / 400.0)); }
+
+// moyenne et variance du score par partie
+static void score_stats(const Score &s, double &mean, double &var) {
+    int n = s.games();
+    mean = n ? (s.wins + 0.5 * s.draws) / n : 0.5;
+    var = n ? (s.wins * std::pow(1 - mean, 2) + s.draws * std::pow(0.5 - mean, 2)
+               + s.losses * std::pow(mean, 2)) / n : 0.0;
+}
+
+// Elo et marge à 95 %
+static void elo_interval(const Score &s, double &elo, double &margin) {
+    double mean, var;
+    score_stats(s, mean, var);
+    double se = s.games() ? std::sqrt(var / s.games()) : 0.0;
+    elo = elo_of(mean);
+    margin = (elo_of(mean + 1.96 * se) - elo_of(mean - 1.96 * se)) / 2;
+}
+
+// probabilité que le premier moteur soit le plus fort
+static double los(const Score &s) {
+    int wl = s.wins + s.losses;
+    return wl ? 0.5 * (1 + std::erf((s.wins - s.losses) / std::sqrt(2.0 * wl))) : 0.5;
+}
+
+// rapport de vraisemblance (GSPRT, approximation normale du score par partie)
+static double sprt_llr(const Score &s, double elo0, double elo1) {
+    double mean, var;
+    score_stats(s, mean, var);
+    if (var <= 0) return 0.0;
+    double s0 = score_of(elo0), s1 = score_of(elo1);
+    return s.games() * (s1 - s0) * (2 * mean - s0 - s1) / (2 * var);
+}
+
+static std::string summary(const MatchOptions &opt, const Score &s) {
+    double elo, margin;
+    elo_interval(s, elo, margin);
+    std::ostringstream os;
+    os << "Games " << s.games() << "  +" << s.wins << " -" << s.losses << " =" << s.draws
+       << std::fixed << std::setprecision(1)
+       << "  Elo " << elo << " +/- " << margin
+       << "  LOS " << 100 * los(s) << "%";
+    if (opt.elo0 != opt.elo1)
+        os << std::setprecision(2) << "  LLR " << sprt_llr(s, opt.elo0, opt.elo1)
+           << " [" << std::log(opt.beta / (1 - opt.alpha)) << ", " << std::log((1 - opt.beta) / opt.alpha) << "]";
+    return os.str();
+}
+
+// =========================
+// PGN
+// =========================
+
+static std::string to_pgn(const MatchOptions &opt, const GameRecord &g, int round) {
+    static const char *RESULT[3] = {"1-0", "0-1", "1/2-1/2"};
+    char date[16];
+    std::time_t now = std::time(nullptr);
+    std::strftime(date, sizeof(date), "%Y.%m.%d", std::localtime(&now));
+
+    std::ostringstream os;
+    os << "[Event \"match\"]\n[Site \"?\"]\n[Date \"" << date << "\"]\n[Round \"" << round << "\"]\n"
+       << "[White \"" << opt.eng[g.white].name << "\"]\n[Black \"" << opt.eng[1 - g.white].name << "\"]\n"
+       << "[Result \"" << RESULT[g.result] << "\"]\n";
+    if (opt.nodes) os << "[TimeControl \"-\"]\n";
+    else if (opt.movetimeMs) os << "[TimeControl \"" << opt.movetimeMs / 1000.0 << "/move\"]\n";
+    else os << "[TimeControl \"" << opt.clockMs / 1000.0 << "+" << opt.incMs / 1000.0 << "\"]\n";
+    if (!g.opening.fen.empty()) os << "[SetUp \"1\"]\n[FEN \"" << g.opening.fen << "\"]\n";
+    os << "[Termination \"" << g.termination << "\"]\n\n";
+
+    Position p;
+    if (g.opening.fen.empty()) set_startpos(p);
+    else set_fen(p, g.opening.fen);
+    int moveNo = p.fullmove;
+    bool white = p.stm == WHITE;
+    std::string text;
+    for (size_t i = 0; i < g.san.size(); ++i) {
+        if (white) text += std::to_string(moveNo) + ". ";
+        else if (i == 0) text += std::to_string(moveNo) + "... ";
+        text += g.san[i] + " ";
+        if (!white) ++moveNo;
+        white = !white;
+    }
+    text += RESULT[g.result];
+    // lignes de 80 caractères au plus
+    size_t col = 0;
+    std::istringstream is(text);
+    std::string w;
+    while (is >> w) {
+        if (col && col + 1 + w.size() > 80) { os << "\n"; col = 0; }
+        else if (col) { os << " "; ++col; }
+        os << w;
+        col += w.size();
+    }
+    os << "\n\n";
+    return os.str();
+}
+
+// =========================
+// Main
+// =========================
+
+static void usage() {
+    std::cout << "Usage: match --engine1 \"<cmd>\" --engine2 \"<cmd>\" [--name1 N] [--name2 N]\n"
+                 "             [--option1 Name=Value] [--option2 Name=Value] (répétables)\n"
+                 "             [--games N] [--concurrency N] [--openings file] [--pgn file]\n"
+                 "             [--nodes N | --movetime ms | --tc base+inc (secondes)] [--margin ms]\n"
+                 "             [--maxplies N] [--sprt elo0 elo1 [alpha beta]]\n"
+                 "  ouvertures : FEN/EPD ou coups UCI par ligne, chacune jouée avec les deux couleurs\n";
+}
+
+int main(int argc, char **argv) {
+    std::signal(SIGPIPE, SIG_IGN);
+
+    MatchOptions opt;
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        bool hasArg = i + 1 < argc;
+        auto option = [&](EngineSpec &e) {
+            std::string kv = argv[++i];
+            size_t eq = kv.find('=');
+            if (eq != std::string::npos) e.options.push_back({kv.substr(0, eq), kv.substr(eq + 1)});
+        };
+        if      (a == "--engine1" && hasArg) opt.eng[0].cmd = argv[++i];
+        else if (a == "--engine2" && hasArg) opt.eng[1].cmd = argv[++i];
+        else if (a == "--name1" && hasArg) opt.eng[0].name = argv[++i];
+        else if (a == "--name2" && hasArg) opt.eng[1].name = argv[++i];
+        else if (a == "--option1" && hasArg) option(opt.eng[0]);
+        else if (a == "--option2" && hasArg) option(opt.eng[1]);
+        else if (a == "--games" && hasArg) opt.games = std::atoi(argv[++i]);
+        else if (a == "--concurrency" && hasArg) opt.concurrency = std::atoi(argv[++i]);
+        else if (a == "--openings" && hasArg) opt.openings = argv[++i];
+        else if (a == "--pgn" && hasArg) opt.pgn = argv[++i];
+        else if (a == "--nodes" && hasArg) opt.nodes = std::strtoull(argv[++i], nullptr, 10);
+        else if (a == "--movetime" && hasArg) opt.movetimeMs = std::atoi(argv[++i]);
+        else if (a == "--tc" && hasArg) {
+            std::string tc = argv[++i];
+            size_t plus = tc.find('+');
+            opt.clockMs = (int)(std::atof(tc.substr(0, plus).c_str()) * 1000);
+            opt.incMs = plus == std::string::npos ? 0 : (int)(std::atof(tc.substr(plus + 1).c_str()) * 1000);
+        }
+        else if (a == "--margin" && hasArg) opt.marginMs = std::atoi(argv[++i]);
+        else if (a == "--maxplies" && hasArg) opt.maxPlies = std::atoi(argv[++i]);
+        else if (a == "--sprt" && i + 2 < argc) {
+            opt.elo0 = std::atof(argv[++i]);
+            opt.elo1 = std::atof(argv[++i]);
+            if (i + 2 < argc && argv[i + 1][0] != '-') {
+                opt.alpha = std::atof(argv[++i]);
+                opt.beta = std::atof(argv[++i]);
+            }
+        }
+        else if (a == "-h" || a == "--help") { usage(); return 0; }
+        else { usage(); return 1; }
+    }
+    if (opt.eng[0].cmd.empty() || opt.eng[1].cmd.empty()) { usage(); return 1; }
+    for (int i = 0; i < 2; ++i)
+        if (opt.eng[i].name.empty()) opt.eng[i].name = opt.eng[i].cmd;
+    opt.games = std::max(2, opt.games + (opt.games & 1));
+    opt.concurrency = std::max(1, opt.concurrency);
+
+    std::vector<Opening> openings;
+    if (!opt.openings.empty()) {
+        openings = load_openings(opt.openings);
+        if (openings.empty()) {
+            std::cerr << "No usable opening in " << opt.openings << "\n";
+            return 1;
+        }
+    }
+    if (openings.empty()) openings.push_back(Opening());
+
+    std::ofstream pgn;
+    if (!opt.pgn.empty()) pgn.open(opt.pgn, std::ios::app);
+
+    std::mutex mtx;
+    Score score;
+    std::atomic<int> next{0};
+    std::atomic<bool> done{false};
+    double lower = std::log(opt.beta / (1 - opt.alpha)), upper = std::log((1 - opt.beta) / opt.alpha);
+    std::string verdict;
+
+    auto worker = [&]() {
+        UciProcess eng[2];
+        bool up = false;
+        for (int g; !done && (g = next++) < opt.games; ) {
+            if (!up) {
+                up = engine_init(eng[0], opt.eng[0]) && engine_init(eng[1], opt.eng[1]);
+                if (!up) {
+                    std::lock_guard<std::mutex> lk(mtx);
+                    std::cerr << "Cannot start engines\n";
+                    done = true;
+                    break;
+                }
+            }
+            GameRecord rec;
+            rec.opening = openings[(size_t)(g / 2) % openings.size()];
+            rec.white = g & 1;          // couleurs inversées d'une partie à l'autre
+            bool ok = play_game(opt, eng, rec);
+
+            // un moteur mort ou bloqué : on le relance pour la partie suivante
+            if (!ok || rec.termination == "engine stopped" || rec.termination == "time forfeit") {
+                eng[0].stop(); eng[1].stop();
+                up = false;
+            }
+            if (!ok) continue;
+
+            std::lock_guard<std::mutex> lk(mtx);
+            bool firstWhite = rec.white == 0;
+            if (rec.result == DRAWN) score.draws++;
+            else if ((rec.result == WHITE_WINS) == firstWhite) score.wins++;
+            else score.losses++;
+            if (pgn) pgn << to_pgn(opt, rec, g + 1) << std::flush;
+            std::cout << summary(opt, score) << "\n";
+
+            if (opt.elo0 != opt.elo1 && verdict.empty()) {
+                double llr = sprt_llr(score, opt.elo0, opt.elo1);
+                if (llr >= upper) verdict = "H1 accepted (elo >= " + std::to_string(opt.elo1) + ")";
+                if (llr <= lower) verdict = "H0 accepted (elo <= " + std::to_string(opt.elo0) + ")";
+                if (!verdict.empty()) done = true;
+            }
+        }
+        eng[0].stop(); eng[1].stop();
+    };
+
+    std::vector<std::thread> pool;
+    for (int w = 0; w < opt.concurrency; ++w) pool.emplace_back(worker);
+    for (auto &th : pool) th.join();
+
+    std::cout << "Final: " << opt.eng[0].name << " vs " << opt.eng[1].name << "\n"
+              << summary(opt, score) << "\n";
+    if (opt.elo0 != opt.elo1)
+        std::cout << "SPRT: " << (verdict.empty() ? "inconclusive" : verdict) << "\n";
+    return 0;
+}
@@ -0,0 +1,227 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <vector>
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#define NNUE_MMAP 1
+#endif
+#if defined(__AVX2__)
+#include <immintrin.h> // noyaux int16 (compiler avec -mavx2)
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace cechess {
+
+// =========================
+// Evaluation NNUE (backend optionnel)
+// =========================
+// Réseau 768 -> 256x2 -> 1, entrées = (camp relatif, type, case) vues par
+// chaque camp. Accumulateurs tenus par la pile de la recherche ; sortie
+// = CReLU(accumulateur du trait | accumulateur adverse) . poids de sortie.
+//
+// Fichier : int16 little-endian bruts, éventuellement complétés à 64 octets
+//   ft_w[768][256]  ft_b[256]  out_w[512]  out_b
+// (format "simple" des entraîneurs usuels, quantisation QA=255 / QB=64).
+
+constexpr int NNUE_INPUTS = 768;
+constexpr int NNUE_HIDDEN = 256;
+constexpr int NNUE_QA     = 255;
+constexpr int NNUE_QB     = 64;
+constexpr int NNUE_SCALE  = 400;   // sortie du réseau -> centipions
+
+struct NNUENet {
+    const int16_t *ft_w  = nullptr;  // [NNUE_INPUTS][NNUE_HIDDEN]
+    const int16_t *ft_b  = nullptr;  // [NNUE_HIDDEN]
+    const int16_t *out_w = nullptr;  // [2*NNUE_HIDDEN] : trait puis adversaire
+    int16_t out_b = 0;
+
+    void *map = nullptr;             // fichier projeté en mémoire
+    size_t map_len = 0;
+    std::vector<int16_t> buf;        // repli sans mmap
+    std::string path;
+};
+
+// [perspective][neurone] ; hors de Position, dans la pile de SearchThread
+struct alignas(64) Accumulator {
+    int16_t v[2][NNUE_HIDDEN];
+};
+
+static NNUENet nnue_net;
+static bool use_nnue = false;        // backend actif ; ne changer qu'hors recherche
+
+inline bool nnue_loaded(){ return nnue_net.ft_w != nullptr; }
+
+inline size_t nnue_file_values(){
+    return (size_t)NNUE_INPUTS*NNUE_HIDDEN + NNUE_HIDDEN + 2*NNUE_HIDDEN + 1;
+}
+
+inline void nnue_unload(){
+    NNUENet &n = nnue_net;
+#ifdef NNUE_MMAP
+    if(n.map) munmap(n.map, n.map_len);
+#endif
+    n.map = nullptr; n.map_len = 0;
+    n.buf.clear(); n.buf.shrink_to_fit();
+    n.ft_w = n.ft_b = n.out_w = nullptr;
+    n.out_b = 0;
+    n.path.clear();
+    use_nnue = false;
+}
+
+// charge 'path' (mmap si possible) ; false si le fichier n'a pas la bonne taille
+inline bool nnue_load(const std::string &path){
+    const size_t need = nnue_file_values() * sizeof(int16_t);
+    const int16_t *w = nullptr;
+    void *map = nullptr;
+    size_t len = 0;
+    std::vector<int16_t> buf;
+
+#ifdef NNUE_MMAP
+    int fd = open(path.c_str(), O_RDONLY);
+    if(fd < 0) return false;
+    struct stat st;
+    if(fstat(fd, &st) != 0){ close(fd); return false; }
+    len = (size_t)st.st_size;
+    if(len < need || len >= need + 64){ close(fd); return false; }
+    map = mmap(nullptr, len, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(map == MAP_FAILED) return false;
+    w = (const int16_t*)map;
+#else
+    std::FILE *f = std::fopen(path.c_str(), "rb");
+    if(!f) return false;
+    std::fseek(f, 0, SEEK_END);
+    long sz = std::ftell(f);
+    std::fseek(f, 0, SEEK_SET);
+    if(sz < (long)need || sz >= (long)(need + 64)){ std::fclose(f); return false; }
+    buf.resize(nnue_file_values());
+    bool ok = std::fread(buf.data(), sizeof(int16_t), buf.size(), f) == buf.size();
+    std::fclose(f);
+    if(!ok) return false;
+    w = buf.data();
+#endif
+
+    nnue_unload();
+    NNUENet &n = nnue_net;
+    n.map = map; n.map_len = len;
+    n.buf.swap(buf);
+    n.ft_w  = w;
+    n.ft_b  = n.ft_w + (size_t)NNUE_INPUTS*NNUE_HIDDEN;
+    n.out_w = n.ft_b + NNUE_HIDDEN;
+    n.out_b = n.out_w[2*NNUE_HIDDEN];
+    n.path  = path;
+    return true;
+}
+
+// index d'entrée vu par 'persp' : ses pièces d'abord, échiquier retourné pour les noirs
+inline int nnue_index(int persp, int c, int t, int s){
+    return (c==persp ? 0 : 384) + t*64 + (persp==0 ? s : s^56);
+}
+
+// --- Noyaux int16 ---
+
+inline void nnue_add_row(int16_t *acc, const int16_t *w){
+#if defined(__AVX2__)
+    for(int i=0;i<NNUE_HIDDEN;i+=16){
+        __m256i a = _mm256_loadu_si256((const __m256i*)(acc+i));
+        __m256i b = _mm256_loadu_si256((const __m256i*)(w+i));
+        _mm256_storeu_si256((__m256i*)(acc+i), _mm256_add_epi16(a,b));
+    }
+#elif defined(__ARM_NEON)
+    for(int i=0;i<NNUE_HIDDEN;i+=8)
+        vst1q_s16(acc+i, vaddq_s16(vld1q_s16(acc+i), vld1q_s16(w+i)));
+#else
+    for(int i=0;i<NNUE_HIDDEN;i++) acc[i] += w[i];
+#endif
+}
+
+inline void nnue_sub_row(int16_t *acc, const int16_t *w){
+#if defined(__AVX2__)
+    for(int i=0;i<NNUE_HIDDEN;i+=16){
+        __m256i a = _mm256_loadu_si256((const __m256i*)(acc+i));
+        __m256i b = _mm256_loadu_si256((const __m256i*)(w+i));
+        _mm256_storeu_si256((__m256i*)(acc+i), _mm256_sub_epi16(a,b));
+    }
+#elif defined(__ARM_NEON)
+    for(int i=0;i<NNUE_HIDDEN;i+=8)
+        vst1q_s16(acc+i, vsubq_s16(vld1q_s16(acc+i), vld1q_s16(w+i)));
+#else
+    for(int i=0;i<NNUE_HIDDEN;i++) acc[i] -= w[i];
+#endif
+}
+
+// somme de CReLU(acc[i]) * w[i]
+inline int32_t nnue_dot(const int16_t *acc, const int16_t *w){
+#if defined(__AVX2__)
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i qa   = _mm256_set1_epi16(NNUE_QA);
+    __m256i sum = _mm256_setzero_si256();
+    for(int i=0;i<NNUE_HIDDEN;i+=16){
+        __m256i a = _mm256_loadu_si256((const __m256i*)(acc+i));
+        a = _mm256_min_epi16(_mm256_max_epi16(a, zero), qa);
+        sum = _mm256_add_epi32(sum, _mm256_madd_epi16(a, _mm256_loadu_si256((const __m256i*)(w+i))));
+    }
+    __m128i s = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0x4E));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0xB1));
+    return _mm_cvtsi128_si32(s);
+#elif defined(__ARM_NEON)
+    const int16x8_t zero = vdupq_n_s16(0);
+    const int16x8_t qa   = vdupq_n_s16(NNUE_QA);
+    int32x4_t sum = vdupq_n_s32(0);
+    for(int i=0;i<NNUE_HIDDEN;i+=8){
+        int16x8_t a = vminq_s16(vmaxq_s16(vld1q_s16(acc+i), zero), qa);
+        int16x8_t b = vld1q_s16(w+i);
+        sum = vmlal_s16(sum, vget_low_s16(a), vget_low_s16(b));
+        sum = vmlal_s16(sum, vget_high_s16(a), vget_high_s16(b));
+    }
+    return vaddvq_s32(sum);
+#else
+    int32_t sum = 0;
+    for(int i=0;i<NNUE_HIDDEN;i++){
+        int a = acc[i] < 0 ? 0 : acc[i] > NNUE_QA ? NNUE_QA : acc[i];
+        sum += a * w[i];
+    }
+    return sum;
+#endif
+}
+
+// --- Accumulateur ---
+
+inline void nnue_reset(Accumulator &a){
+    for(int p=0;p<2;p++)
+        for(int i=0;i<NNUE_HIDDEN;i++) a.v[p][i] = nnue_net.ft_b[i];
+}
+
+inline void nnue_add(Accumulator &a, int c, int t, int s){
+    for(int p=0;p<2;p++)
+        nnue_add_row(a.v[p], nnue_net.ft_w + (size_t)nnue_index(p,c,t,s)*NNUE_HIDDEN);
+}
+
+inline void nnue_sub(Accumulator &a, int c, int t, int s){
+    for(int p=0;p<2;p++)
+        nnue_sub_row(a.v[p], nnue_net.ft_w + (size_t)nnue_index(p,c,t,s)*NNUE_HIDDEN);
+}
+
+inline void nnue_move(Accumulator &a, int c, int t, int from, int to){
+    for(int p=0;p<2;p++){
+        nnue_sub_row(a.v[p], nnue_net.ft_w + (size_t)nnue_index(p,c,t,from)*NNUE_HIDDEN);
+        nnue_add_row(a.v[p], nnue_net.ft_w + (size_t)nnue_index(p,c,t,to)*NNUE_HIDDEN);
+    }
+}
+
+// score en centipions du point de vue de 'stm'
+inline int nnue_evaluate(const Accumulator &a, int stm){
+    int32_t out = nnue_dot(a.v[stm],   nnue_net.out_w)
+                + nnue_dot(a.v[stm^1], nnue_net.out_w + NNUE_HIDDEN);
+    return (int)(((int64_t)out + nnue_net.out_b) * NNUE_SCALE / (NNUE_QA*NNUE_QB));
+}
+
+} // namespace cechess
@@ -0,0 +1,156 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "engine2.hpp"
+
+namespace cechess {
+
+// =========================
+// Positions compactes (données d'entraînement)
+// =========================
+// Un enregistrement = 32 octets, little-endian, sans alignement :
+//   [0..7]   occupation (bit = case)
+//   [8..23]  pièces des cases occupées, dans l'ordre des bits, 4 bits chacune
+//            (valeur de Piece : 1..12), quartet de poids faible d'abord
+//   [24]     trait (bit 0) | roques << 1
+//   [25]     case en passant, 64 si aucune
+//   [26]     demi-coups (règle des 50 coups, plafonné à 255)
+//   [27..28] numéro du coup
+//   [29..30] score de la recherche, centipions, point de vue des blancs
+//   [31]     résultat de la partie : 0 = noirs gagnent, 1 = nulle, 2 = blancs gagnent
+
+constexpr int PACKED_BYTES = 32;
+constexpr int PACKED_NO_EP = 64;
+
+struct PackedPos {
+    unsigned char b[PACKED_BYTES];
+};
+static_assert(sizeof(PackedPos) == PACKED_BYTES, "PackedPos doit faire 32 octets");
+
+enum PackedResult { RESULT_BLACK = 0, RESULT_DRAW = 1, RESULT_WHITE = 2 };
+
+inline void put_le(unsigned char *q, U64 v, int bytes){
+    for(int i=0;i<bytes;i++) q[i] = (unsigned char)(v >> (8*i));
+}
+
+inline U64 get_le(const unsigned char *q, int bytes){
+    U64 v = 0;
+    for(int i=bytes-1;i>=0;i--) v = v<<8 | q[i];
+    return v;
+}
+
+// score (point de vue des blancs) et résultat : voir PackedResult
+inline PackedPos pack_position(const Position &p, int score, int result){
+    PackedPos r{};
+    U64 occ = occupied(p);
+    put_le(r.b, occ, 8);
+    int i = 0;
+    for(U64 o=occ; o; i++){
+        int s = pop_lsb(o);
+        r.b[8 + i/2] |= (unsigned char)(p.board[s] << (4*(i&1)));
+    }
+    r.b[24] = (unsigned char)(p.stm | (p.castling & 15) << 1);
+    r.b[25] = (unsigned char)(p.ep == -1 ? PACKED_NO_EP : p.ep);
+    r.b[26] = (unsigned char)std::min(p.halfmove, 255);
+    put_le(r.b + 27, (U64)std::clamp(p.fullmove, 0, 65535), 2);
+    put_le(r.b + 29, (U64)(uint16_t)(int16_t)std::clamp(score, -32767, 32767), 2);
+    r.b[31] = (unsigned char)result;
+    return r;
+}
+
+// false si l'enregistrement ne décrit pas une position utilisable
+inline bool unpack_position(const PackedPos &r, Position &p, int &score, int &result){
+    Position np;
+    U64 occ = get_le(r.b, 8);
+    if(bb_count(occ) > 32) return false;
+    int i = 0;
+    for(U64 o=occ; o; i++){
+        int s = pop_lsb(o);
+        int pc = (r.b[8 + i/2] >> (4*(i&1))) & 15;
+        if(pc < W_PAWN || pc > B_KING) return false;
+        np.board[s] = Piece(pc);
+    }
+    update_occupancy(np);
+    if(bb_count(pieces(np,WHITE,KING))!=1 || bb_count(pieces(np,BLACK,KING))!=1) return false;
+
+    np.stm      = Color(r.b[24] & 1);
+    np.castling = (r.b[24] >> 1) & 15;
+    np.ep       = r.b[25] < 64 ? r.b[25] : -1;
+    np.halfmove = r.b[26];
+    np.fullmove = (int)get_le(r.b + 27, 2);
+    np.key      = compute_key(np);
+    score  = (int16_t)get_le(r.b + 29, 2);
+    result = r.b[31];
+    if(result > RESULT_WHITE) return false;
+    p = np;
+    return true;
+}
+
+// Écriture en flux : les enregistrements s'accumulent dans un tampon de
+// 'chunk' entrées, écrit d'un bloc ; sûr entre threads.
+struct PackedWriter {
+    std::FILE *f = nullptr;
+    std::vector<PackedPos> buf;
+    size_t chunk = 1 << 16;   // 2 Mo
+    std::atomic<U64> written{0}; // enregistrements envoyés au fichier
+    std::mutex mtx;
+
+    PackedWriter() = default;
+    PackedWriter(const PackedWriter &) = delete;
+    PackedWriter &operator=(const PackedWriter &) = delete;
+    ~PackedWriter();
+};
+
+// ajoute à la fin d'un fichier existant
+inline bool packed_open(PackedWriter &w, const std::string &path){
+    w.f = std::fopen(path.c_str(), "ab");
+    if(!w.f) return false;
+    std::setvbuf(w.f, nullptr, _IONBF, 0); // déjà tamponné par blocs
+    w.buf.reserve(w.chunk);
+    return true;
+}
+
+inline bool packed_flush_locked(PackedWriter &w){
+    if(w.buf.empty() || !w.f) return true;
+    size_t n = std::fwrite(w.buf.data(), sizeof(PackedPos), w.buf.size(), w.f);
+    w.written += n;
+    bool ok = n == w.buf.size();
+    w.buf.clear();
+    return ok;
+}
+
+// une partie entière d'un coup : les fichiers restent lisibles partie par partie
+inline bool packed_write(PackedWriter &w, const PackedPos *recs, size_t n){
+    std::lock_guard<std::mutex> lk(w.mtx);
+    w.buf.insert(w.buf.end(), recs, recs + n);
+    return w.buf.size() < w.chunk || packed_flush_locked(w);
+}
+
+inline bool packed_close(PackedWriter &w){
+    std::lock_guard<std::mutex> lk(w.mtx);
+    bool ok = packed_flush_locked(w);
+    if(w.f && std::fclose(w.f) != 0) ok = false;
+    w.f = nullptr;
+    return ok;
+}
+
+inline PackedWriter::~PackedWriter(){ packed_close(*this); }
+
+// lit tout un fichier d'enregistrements (une fin tronquée est ignorée)
+inline bool packed_load(const std::string &path, std::vector<PackedPos> &out){
+    std::FILE *f = std::fopen(path.c_str(), "rb");
+    if(!f) return false;
+    PackedPos chunk[4096];
+    size_t n;
+    while((n = std::fread(chunk, sizeof(PackedPos), 4096, f)) > 0)
+        out.insert(out.end(), chunk, chunk + n);
+    std::fclose(f);
+    return true;
+}
+
+} // namespace cechess
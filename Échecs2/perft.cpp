@@ -0,0 +1,235 @@
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+#include <cctype>
+#include "engine2.hpp"
+
+using namespace cechess;
+
+// =========================
+// Positions de référence (chessprogramming.org, "Perft Results")
+// =========================
+
+struct PerftCase {
+    const char *name;
+    const char *fen;
+    std::vector<U64> expected; // expected[d-1] = perft(d)
+};
+
+static const std::vector<PerftCase> SUITE = {
+    {"startpos", "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+        {20, 400, 8902, 197281, 4865609, 119060324}},
+    {"kiwipete", "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+        {48, 2039, 97862, 4085603, 193690690}},
+    {"pos3",     "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+        {14, 191, 2812, 43238, 674624, 11030083}},
+    {"pos4",     "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+        {6, 264, 9467, 422333, 15833292}},
+    {"pos5",     "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+        {44, 1486, 62379, 2103487, 89941194}},
+    {"pos6",     "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+        {46, 2079, 89890, 3894594, 164075551}},
+};
+
+// =========================
+// Perft (option bulk + table de hachage)
+// =========================
+
+struct PerftEntry {
+    U64 key = 0;
+    U64 nodes = 0;
+    int depth = 0;
+};
+
+struct PerftOptions {
+    bool bulk = false;                 // compte les coups légaux au dernier niveau sans les jouer
+    bool verify = false;               // unmake doit rendre la position à l'identique
+    std::vector<PerftEntry> hash;      // vide = pas de hachage
+    U64 errors = 0;                    // --verify : restaurations fautives
+};
+
+// =========================
+// Vérification make / unmake (--verify)
+// =========================
+
+// premier champ qui diffère, nullptr si les positions sont identiques
+static const char *position_diff(const Position &a, const Position &b) {
+    if (!std::equal(a.board, a.board + 64, b.board)) return "board";
+    if (!std::equal(a.by_type, a.by_type + 6, b.by_type)) return "by_type";
+    if (!std::equal(a.occ, a.occ + 2, b.occ)) return "occ";
+    if (a.stm != b.stm) return "stm";
+    if (a.castling != b.castling) return "castling";
+    if (a.ep != b.ep) return "ep";
+    if (a.halfmove != b.halfmove) return "halfmove";
+    if (a.fullmove != b.fullmove) return "fullmove";
+    if (a.key != b.key) return "key";
+    if (a.pawn_key != b.pawn_key) return "pawn_key";
+    if (!std::equal(a.psq_mg, a.psq_mg + 2, b.psq_mg)) return "psq_mg";
+    if (!std::equal(a.psq_eg, a.psq_eg + 2, b.psq_eg)) return "psq_eg";
+    if (a.phase != b.phase) return "phase";
+    return nullptr;
+}
+
+static void check_restored(const Position &before, const Position &after, const std::string &what,
+                           PerftOptions &opt) {
+    const char *field = position_diff(before, after);
+    if (!field) return;
+    if (++opt.errors <= 10)
+        std::cout << "  VERIFY: " << what << " changes '" << field << "' in " << get_fen(before) << "\n";
+}
+
+// coup nul (hors échec, comme la recherche) joué puis défait
+static void verify_null_move(Position &p, PerftOptions &opt) {
+    if (in_check(p, p.stm)) return;
+    Position before = p;
+    Undo u;
+    make_null_move(p, u);
+    unmake_null_move(p, u);
+    check_restored(before, p, "null move", opt);
+}
+
+static U64 perft(Position &p, int depth, PerftOptions &opt);
+
+// joue m, compte le sous-arbre puis défait m
+static U64 perft_move(Position &p, int m, int depth, PerftOptions &opt) {
+    Position before;
+    if (opt.verify) before = p;
+    Undo u;
+    make_move(p, m, u);
+    U64 c = perft(p, depth, opt);
+    unmake_move(p, m, u);
+    if (opt.verify) check_restored(before, p, "unmake " + move_to_str(m), opt);
+    return c;
+}
+
+// =========================
+// Perft
+// =========================
+
+static U64 perft(Position &p, int depth, PerftOptions &opt) {
+    if (depth == 0) return 1;
+
+    PerftEntry *e = nullptr;
+    if (!opt.hash.empty() && depth > 1) {
+        e = &opt.hash[p.key % opt.hash.size()];
+        if (e->key == p.key && e->depth == depth) return e->nodes;
+    }
+
+    int moves[256];
+    int n = generate_legal_moves(p, moves);
+    if (opt.verify) verify_null_move(p, opt);
+    if (depth == 1 && opt.bulk) return (U64)n;
+
+    U64 total = 0;
+    for (int i = 0; i < n; ++i)
+        total += perft_move(p, moves[i], depth - 1, opt);
+
+    if (e) {
+        e->key = p.key; e->depth = depth; e->nodes = total;
+    }
+    return total;
+}
+
+// divide : compte par coup racine, puis total + vitesse
+static U64 divide(Position &p, int depth, PerftOptions &opt, bool show) {
+    auto t0 = std::chrono::steady_clock::now();
+
+    int moves[256];
+    int n = generate_legal_moves(p, moves);
+    if (opt.verify) verify_null_move(p, opt);
+    U64 total = 0;
+    for (int i = 0; i < n; ++i) {
+        U64 c = perft_move(p, moves[i], depth - 1, opt);
+        total += c;
+        if (show) std::cout << "  " << move_to_str(moves[i]) << ": " << c << "\n";
+    }
+
+    double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    std::cout << "  depth " << depth
+              << "  nodes " << total
+              << "  time " << std::fixed << std::setprecision(3) << sec << "s"
+              << "  nps " << (U64)(sec > 0 ? total / sec : 0) << "\n";
+    return total;
+}
+
+// =========================
+// Main
+// =========================
+
+static void usage() {
+    std::cout << "Usage: perft [depth] [--bulk] [--hash MB] [--divide] [--verify] [--fen \"<fen>\"]\n"
+                 "  sans --fen : suite de référence jusqu'à 'depth' (défaut 4), avec vérification\n"
+                 "  --fen      : divide sur la position donnée\n"
+                 "  --verify   : chaque unmake_move / unmake_null_move doit restaurer tous les\n"
+                 "               champs de Position (ignore --bulk et --hash : tout est joué)\n";
+}
+
+int main(int argc, char **argv) {
+    int depth = 4;
+    bool showDivide = false;
+    std::string fen;
+    PerftOptions opt;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a == "--bulk") opt.bulk = true;
+        else if (a == "--divide") showDivide = true;
+        else if (a == "--verify") opt.verify = true;
+        else if (a == "--hash" && i + 1 < argc) {
+            size_t mb = std::strtoul(argv[++i], nullptr, 10);
+            opt.hash.assign(mb * 1024 * 1024 / sizeof(PerftEntry), PerftEntry());
+        }
+        else if (a == "--fen" && i + 1 < argc) fen = argv[++i];
+        else if (a == "-h" || a == "--help") { usage(); return 0; }
+        else if (std::isdigit((unsigned char)a[0])) depth = std::atoi(a.c_str());
+        else { usage(); return 1; }
+    }
+    if (depth < 1) depth = 1;
+    if (opt.verify) {
+        opt.bulk = false;
+        opt.hash.clear();
+    }
+
+    if (!fen.empty()) {
+        Position p;
+        if (!set_fen(p, fen)) {
+            std::cout << "Invalid FEN.\n";
+            return 1;
+        }
+        divide(p, depth, opt, true);
+        if (opt.verify) std::cout << "Verify " << (opt.errors ? "FAILED" : "OK") << "\n";
+        return opt.errors ? 1 : 0;
+    }
+
+    bool allOk = true;
+    U64 allNodes = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (const PerftCase &c : SUITE) {
+        Position p;
+        set_fen(p, c.fen);
+        int d = std::min<int>(depth, (int)c.expected.size());
+        std::cout << c.name << "  " << c.fen << "\n";
+        U64 got = divide(p, d, opt, showDivide);
+        allNodes += got;
+        bool ok = got == c.expected[d - 1];
+        if (!ok) {
+            allOk = false;
+            std::cout << "  FAIL: expected " << c.expected[d - 1] << "\n";
+        }
+        if (!opt.hash.empty())
+            std::fill(opt.hash.begin(), opt.hash.end(), PerftEntry());
+    }
+    if (opt.errors) {
+        allOk = false;
+        std::cout << "Verify: " << opt.errors << " bad restores\n";
+    }
+    double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    std::cout << "Total nodes " << allNodes
+              << "  nps " << (U64)(sec > 0 ? allNodes / sec : 0)
+              << "  " << (allOk ? "OK" : "FAILED") << "\n";
+    return allOk ? 0 : 1;
+}
@@ -0,0 +1,381 @@
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <thread>
+#include "engine2.hpp"
+#include "packed.hpp"
+
+using namespace cechess;
+
+// =========================
+// Réglage des poids de l'éval (méthode de Texel)
+// =========================
+// L'éval classique est linéaire en ses poids : pour chaque position on relève
+// une seule fois le coefficient de chaque poids (blancs - noirs), puis on
+// minimise l'erreur quadratique entre sigmoïde(éval) et le résultat de la
+// partie par descente de gradient (Adam), répartie entre threads.
+// Entrée : fichiers de datagen (packed.hpp). Sortie : eval_weights.hpp.
+
+// paramètres : matériel, PST, termes ; chacun a un poids MG et un poids EG
+constexpr int P_MAT   = 0;
+constexpr int P_PST   = P_MAT + 6;
+constexpr int P_TERM  = P_PST + 6*64;
+constexpr int P_COUNT = P_TERM + EVAL_TERM_NB;
+
+struct TuneOptions {
+    std::vector<std::string> data;
+    std::string out = "eval_weights.hpp";
+    int threads = 0;            // 0 = un par coeur
+    int epochs = 1000;
+    int report = 50;            // erreur affichée toutes les N époques
+    double lr = 1.0;            // pas d'Adam, en centipions
+    double k = 0;               // échelle de la sigmoïde ; 0 = ajustée sur les données
+    double lambda = 1.0;        // cible : lambda * résultat + (1-lambda) * sigmoïde(score)
+    long long maxPositions = 0; // 0 = tout
+};
+
+static void usage() {
+    std::cout << "Usage: tuner data.bin [data2.bin ...] [--out eval_weights.hpp] [--epochs N]\n"
+                 "             [--lr cp] [--k K] [--lambda L] [--threads N] [--max N] [--report N]\n"
+                 "  --epochs 0 : réécrit les poids actuels (ajuste seulement K)\n";
+}
+
+// coefficient non nul d'une position : 4 octets
+struct TuneCoef {
+    uint16_t param;
+    int16_t n;
+};
+
+// position : tranche de coefficients dans un tableau commun (16 octets)
+struct TuneEntry {
+    uint32_t begin;
+    uint16_t count;
+    uint8_t phase;     // 0..24
+    uint8_t result;    // PackedResult
+    int16_t score;     // recherche, point de vue des blancs
+    float target;
+};
+
+struct TuneSet {
+    std::vector<TuneEntry> entries;
+    std::vector<TuneCoef> coefs;
+};
+
+// relève les coefficients d'un camp, au signe près
+struct EvalTrace {
+    int coef[EVAL_TERM_NB]{};
+    int sign = 1;
+    void add(int term, int n){ coef[term] += sign*n; }
+};
+
+static int clamped_phase(const Position &p) { return std::clamp(p.phase, 0, 24); }
+
+// coefficients de tous les paramètres (blancs - noirs)
+static void trace_position(const Position &p, int *coef) {
+    std::fill(coef, coef + P_COUNT, 0);
+    EvalTrace tr;
+    int phase = clamped_phase(p);
+    for (int c = 0; c < 2; ++c) {
+        int sign = c == WHITE ? 1 : -1;
+        for (int t = 0; t < 6; ++t)
+            for (U64 b = pieces(p,c,t); b; ) {
+                int s = pop_lsb(b);
+                coef[P_MAT + t] += sign;
+                coef[P_PST + t*64 + pst_idx(c, s)] += sign;
+            }
+        tr.sign = sign;
+        U64 passed;
+        eval_pawns(p, (Color)c, tr, passed);
+        eval_pieces(p, (Color)c, phase, tr);
+    }
+    for (int i = 0; i < EVAL_TERM_NB; ++i) coef[P_TERM + i] = tr.coef[i];
+}
+
+// poids courants, rangés MG/EG côte à côte : w[2*i], w[2*i+1]
+static std::vector<double> initial_weights() {
+    std::vector<double> w(2 * P_COUNT);
+    for (int t = 0; t < 6; ++t) {
+        w[2*(P_MAT + t)] = MAT_MG[t];
+        w[2*(P_MAT + t) + 1] = MAT_EG[t];
+        for (int s = 0; s < 64; ++s) {
+            w[2*(P_PST + t*64 + s)] = PST_MG[t][s];
+            w[2*(P_PST + t*64 + s) + 1] = PST_EG[t][s];
+        }
+    }
+    for (int i = 0; i < EVAL_TERM_NB; ++i) {
+        w[2*(P_TERM + i)] = EVAL_W[i][0];
+        w[2*(P_TERM + i) + 1] = EVAL_W[i][1];
+    }
+    return w;
+}
+
+static inline double linear_eval(const TuneCoef *c, int count, int phase, const double *w) {
+    double mg = 0, eg = 0;
+    for (int i = 0; i < count; ++i) {
+        mg += c[i].n * w[2*c[i].param];
+        eg += c[i].n * w[2*c[i].param + 1];
+    }
+    return (mg * phase + eg * (24 - phase)) / 24.0;
+}
+
+static inline double linear_eval(const TuneSet &set, const TuneEntry &e, const double *w) {
+    return linear_eval(set.coefs.data() + e.begin, e.count, e.phase, w);
+}
+
+static inline double sigmoid(double k, double cp) { return 1.0 / (1.0 + std::pow(10.0, -k * cp / 400.0)); }
+
+// découpe [0, n) en tranches, une par thread ; f(begin, end, index)
+template<class F>
+static void parallel_for(size_t n, int threads, F f) {
+    std::vector<std::thread> pool;
+    size_t step = (n + threads - 1) / threads;
+    for (int t = 1; t < threads; ++t) {
+        size_t b = std::min(n, t * step), e = std::min(n, b + step);
+        pool.emplace_back(f, b, e, t);
+    }
+    f(0, std::min(n, step), 0);
+    for (auto &th : pool) th.join();
+}
+
+// charge un fichier : coefficients relevés en parallèle, puis concaténés
+static bool load_file(const std::string &path, const TuneOptions &opt, TuneSet &set, int &drift) {
+    std::vector<PackedPos> recs;
+    if (!packed_load(path, recs)) return false;
+    if (opt.maxPositions && (long long)(set.entries.size() + recs.size()) > opt.maxPositions)
+        recs.resize(std::max(0LL, opt.maxPositions - (long long)set.entries.size()));
+
+    struct Part { std::vector<TuneEntry> entries; std::vector<TuneCoef> coefs; int drift = 0; };
+    std::vector<Part> parts(opt.threads);
+    std::vector<double> w = initial_weights();
+    parallel_for(recs.size(), opt.threads, [&](size_t b, size_t e, int t) {
+        Part &part = parts[t];
+        std::vector<int> coef(P_COUNT);
+        for (size_t i = b; i < e; ++i) {
+            Position p;
+            int score, result;
+            if (!unpack_position(recs[i], p, score, result)) continue;
+            trace_position(p, coef.data());
+            TuneEntry en{(uint32_t)part.coefs.size(), 0, (uint8_t)clamped_phase(p), (uint8_t)result, (int16_t)score, 0.0f};
+            for (int j = 0; j < P_COUNT; ++j)
+                if (coef[j]) {
+                    part.coefs.push_back({(uint16_t)j, (int16_t)coef[j]});
+                    ++en.count;
+                }
+            part.entries.push_back(en);
+
+            // contrôle : les coefficients doivent redonner l'éval du moteur
+            // (à l'arrondi près des deux divisions entières)
+            int white = p.stm == WHITE ? eval(p) : -eval(p);
+            double lin = linear_eval(part.coefs.data() + en.begin, en.count, en.phase, w.data());
+            part.drift = std::max(part.drift, (int)std::ceil(std::abs(lin - white)));
+        }
+    });
+
+    for (Part &part : parts) {
+        size_t base = set.coefs.size();
+        if (base + part.coefs.size() > UINT32_MAX) return false;
+        for (TuneEntry &en : part.entries) {
+            en.begin += (uint32_t)base;
+            set.entries.push_back(en);
+        }
+        set.coefs.insert(set.coefs.end(), part.coefs.begin(), part.coefs.end());
+        drift = std::max(drift, part.drift);
+    }
+    return true;
+}
+
+// erreur moyenne ; vsResult : contre le résultat seul (ajustement de K)
+static double total_error(const TuneSet &set, const double *w, double k, bool vsResult, int threads) {
+    std::vector<double> sums(threads, 0.0);
+    parallel_for(set.entries.size(), threads, [&](size_t b, size_t e, int t) {
+        double sum = 0;
+        for (size_t i = b; i < e; ++i) {
+            const TuneEntry &en = set.entries[i];
+            double target = vsResult ? en.result / 2.0 : en.target;
+            double d = target - sigmoid(k, linear_eval(set, en, w));
+            sum += d * d;
+        }
+        sums[t] = sum;
+    });
+    double sum = 0;
+    for (double s : sums) sum += s;
+    return sum / std::max<size_t>(1, set.entries.size());
+}
+
+// K minimisant l'erreur avec les poids actuels (section dorée sur [0, 4])
+static double fit_k(const TuneSet &set, const double *w, int threads) {
+    const double g = (std::sqrt(5.0) - 1) / 2;
+    double a = 0, b = 4;
+    double x1 = b - g*(b-a), x2 = a + g*(b-a);
+    double f1 = total_error(set, w, x1, true, threads), f2 = total_error(set, w, x2, true, threads);
+    while (b - a > 1e-4) {
+        if (f1 < f2) { b = x2; x2 = x1; f2 = f1; x1 = b - g*(b-a); f1 = total_error(set, w, x1, true, threads); }
+        else         { a = x1; x1 = x2; f1 = f2; x2 = a + g*(b-a); f2 = total_error(set, w, x2, true, threads); }
+    }
+    return (a + b) / 2;
+}
+
+// gradient de l'erreur moyenne ; renvoie l'erreur
+static double gradient(const TuneSet &set, const double *w, double k, int threads, std::vector<double> &grad) {
+    std::vector<std::vector<double>> local(threads, std::vector<double>(2 * P_COUNT));
+    std::vector<double> sums(threads, 0.0);
+    parallel_for(set.entries.size(), threads, [&](size_t b, size_t e, int t) {
+        double *gr = local[t].data();
+        double sum = 0;
+        for (size_t i = b; i < e; ++i) {
+            const TuneEntry &en = set.entries[i];
+            double s = sigmoid(k, linear_eval(set, en, w));
+            double d = en.target - s;
+            sum += d * d;
+            // d(erreur)/d(éval), le facteur commun 2*K*ln(10)/400 est appliqué à la fin
+            double g = -d * s * (1 - s);
+            double gm = g * en.phase / 24.0, ge = g * (24 - en.phase) / 24.0;
+            const TuneCoef *c = set.coefs.data() + en.begin;
+            for (int j = 0; j < en.count; ++j) {
+                gr[2*c[j].param]     += gm * c[j].n;
+                gr[2*c[j].param + 1] += ge * c[j].n;
+            }
+        }
+        sums[t] = sum;
+    });
+    double n = (double)std::max<size_t>(1, set.entries.size());
+    double scale = 2 * k * std::log(10.0) / 400.0 / n;
+    std::fill(grad.begin(), grad.end(), 0.0);
+    double err = 0;
+    for (int t = 0; t < threads; ++t) {
+        for (int i = 0; i < 2 * P_COUNT; ++i) grad[i] += local[t][i] * scale;
+        err += sums[t];
+    }
+    return err / n;
+}
+
+// réécrit eval_weights.hpp avec les poids arrondis
+static bool write_weights(const std::string &path, const std::vector<double> &w) {
+    std::ofstream f(path);
+    if (!f) return false;
+    auto v = [&](int param, int half) { return (int)std::lround(w[2*param + half]); };
+    auto num = [](int x, int width) { std::ostringstream s; s << std::setw(width) << x; return s.str(); };
+    static const char *names[6] = {"PAWN", "KNIGHT", "BISHOP", "ROOK", "QUEEN", "KING"};
+
+    f << "#pragma once\n\nnamespace cechess {\n\n"
+         "// =========================\n"
+         "// Poids de l'évaluation classique\n"
+         "// =========================\n"
+         "// Centipions ; chaque poids a une valeur de milieu de partie (MG) et de\n"
+         "// finale (EG), interpolées selon la phase. Fichier réécrit par tuner.cpp\n"
+         "// (--out) : modifier les valeurs à la main reste possible, mais la mise en\n"
+         "// page est celle du générateur.\n\n"
+         "// matériel : P N B R Q K\n";
+    for (int half = 0; half < 2; ++half) {
+        f << "static constexpr int MAT_" << (half ? "EG" : "MG") << "[6] = {";
+        for (int t = 0; t < 6; ++t) f << (t ? "," : "") << num(v(P_MAT + t, half), 4);
+        f << "};\n";
+    }
+    f << "\n// PST vues des blancs : index = case (a1 = 0), 63-case pour les noirs\n";
+    for (int half = 0; half < 2; ++half) {
+        if (half) f << "\n";
+        f << "static constexpr int PST_" << (half ? "EG" : "MG") << "[6][64] = {\n";
+        for (int t = 0; t < 6; ++t) {
+            f << "// " << names[t] << "\n{\n";
+            for (int s = 0; s < 64; ++s)
+                f << num(v(P_PST + t*64 + s, half), 3) << (s == 63 ? "\n" : s % 8 == 7 ? ",\n" : ",");
+            f << (t < 5 ? "},\n" : "}\n");
+        }
+        f << "};\n";
+    }
+    f << "\n// termes de eval_pawns / eval_pieces : poids x nombre d'occurrences\nenum EvalTerm {\n";
+    for (int i = 0; i < EVAL_TERM_NB; ++i) f << "    " << EVAL_TERM_NAMES[i] << ",\n";
+    f << "    EVAL_TERM_NB\n};\n\n"
+         "static constexpr const char *EVAL_TERM_NAMES[EVAL_TERM_NB] = {\n";
+    for (int i = 0; i < EVAL_TERM_NB; ++i)
+        f << "    \"" << EVAL_TERM_NAMES[i] << "\"" << (i + 1 < EVAL_TERM_NB ? ",\n" : "\n");
+    f << "};\n\n// { MG, EG }\nstatic constexpr int EVAL_W[EVAL_TERM_NB][2] = {\n";
+    for (int i = 0; i < EVAL_TERM_NB; ++i)
+        f << "    {" << num(v(P_TERM + i, 0), 4) << "," << num(v(P_TERM + i, 1), 4) << "}"
+          << (i + 1 < EVAL_TERM_NB ? "," : " ") << " // " << EVAL_TERM_NAMES[i] << "\n";
+    f << "};\n\n} // namespace cechess\n";
+    return (bool)f;
+}
+
+int main(int argc, char **argv) {
+    TuneOptions opt;
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        bool hasArg = i + 1 < argc;
+        if      (a == "--out"     && hasArg) opt.out = argv[++i];
+        else if (a == "--epochs"  && hasArg) opt.epochs = std::atoi(argv[++i]);
+        else if (a == "--report"  && hasArg) opt.report = std::max(1, std::atoi(argv[++i]));
+        else if (a == "--lr"      && hasArg) opt.lr = std::atof(argv[++i]);
+        else if (a == "--k"       && hasArg) opt.k = std::atof(argv[++i]);
+        else if (a == "--lambda"  && hasArg) opt.lambda = std::clamp(std::atof(argv[++i]), 0.0, 1.0);
+        else if (a == "--threads" && hasArg) opt.threads = std::atoi(argv[++i]);
+        else if (a == "--max"     && hasArg) opt.maxPositions = std::atoll(argv[++i]);
+        else if (a == "-h" || a == "--help") { usage(); return 0; }
+        else if (!a.empty() && a[0] != '-') opt.data.push_back(a);
+        else { usage(); return 1; }
+    }
+    if (opt.data.empty()) { usage(); return 1; }
+    if (opt.threads <= 0) opt.threads = (int)std::max(1u, std::thread::hardware_concurrency());
+    set_eval_backend(false);
+
+    auto t0 = std::chrono::steady_clock::now();
+    TuneSet set;
+    int drift = 0;
+    for (const std::string &path : opt.data) {
+        if (!load_file(path, opt, set, drift)) {
+            std::cerr << "Cannot load " << path << "\n";
+            return 1;
+        }
+    }
+    if (set.entries.empty()) {
+        std::cerr << "No positions\n";
+        return 1;
+    }
+    double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    std::cerr << "Positions " << set.entries.size() << "  coefficients " << set.coefs.size()
+              << "  memory " << (set.entries.size() * sizeof(TuneEntry) + set.coefs.size() * sizeof(TuneCoef)) / (1 << 20)
+              << " MB  load " << std::fixed << std::setprecision(1) << sec << "s\n";
+    if (drift > 2) std::cerr << "warning: trace differs from eval() by up to " << drift << " cp\n";
+
+    std::vector<double> w = initial_weights();
+    if (opt.k <= 0) opt.k = fit_k(set, w.data(), opt.threads);
+    for (TuneEntry &en : set.entries)
+        en.target = (float)(opt.lambda * en.result / 2.0 + (1 - opt.lambda) * sigmoid(opt.k, en.score));
+    std::cerr << std::setprecision(4) << "K " << opt.k << "  error " << std::setprecision(6)
+              << total_error(set, w.data(), opt.k, false, opt.threads) << "\n";
+
+    // Adam, gradient sur toutes les positions à chaque époque
+    const double b1 = 0.9, b2 = 0.999, eps = 1e-8;
+    std::vector<double> grad(2 * P_COUNT), m(2 * P_COUNT), v(2 * P_COUNT);
+    for (int epoch = 1; epoch <= opt.epochs; ++epoch) {
+        double err = gradient(set, w.data(), opt.k, opt.threads, grad);
+        double c1 = 1 - std::pow(b1, epoch), c2 = 1 - std::pow(b2, epoch);
+        for (int i = 0; i < 2 * P_COUNT; ++i) {
+            m[i] = b1 * m[i] + (1 - b1) * grad[i];
+            v[i] = b2 * v[i] + (1 - b2) * grad[i] * grad[i];
+            w[i] -= opt.lr * (m[i] / c1) / (std::sqrt(v[i] / c2) + eps);
+        }
+        if (epoch % opt.report == 0 || epoch == opt.epochs) {
+            sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+            std::cerr << "epoch " << epoch << "  error " << err << "  time " << std::setprecision(1) << sec << "s\n"
+                      << std::setprecision(6);
+        }
+    }
+
+    // l'éval du moteur utilise des entiers : erreur finale avec les poids arrondis
+    for (double &x : w) x = std::round(x);
+    std::cerr << "Final error " << total_error(set, w.data(), opt.k, false, opt.threads) << "\n";
+    if (!write_weights(opt.out, w)) {
+        std::cerr << "Cannot write " << opt.out << "\n";
+        return 1;
+    }
+    std::cerr << "Weights written to " << opt.out << "\n";
+    return 0;
+}
@@ -0,0 +1,326 @@
+#pragma once
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "engine2.hpp"
+#include "book.hpp"
+
+namespace cechess {
+
+// =========================
+// Protocole UCI
+// =========================
+// La recherche tourne sur un thread à part ; la boucle principale reste
+// disponible pour "stop", "ponderhit", "isready" pendant qu'elle réfléchit.
+
+static std::mutex uci_out_mtx;
+
+static void uci_send(const std::string &line) {
+    std::lock_guard<std::mutex> lk(uci_out_mtx);
+    std::cout << line << std::endl;
+}
+
+// état de la recherche en cours
+static std::thread uci_worker;
+static std::mutex uci_mtx;
+static std::condition_variable uci_cv;
+static bool uci_hold = false;        // go infinite / ponder : bestmove attend stop ou ponderhit
+static bool uci_pondering = false;
+static SearchLimits uci_ponder_limits; // pendule à appliquer au ponderhit
+static bool uci_want_nnue = false;     // option UseNNUE (effective si un réseau est chargé)
+static bool uci_own_book = false;      // option OwnBook
+static int uci_multipv = 1;            // option MultiPV
+
+// lignes "info" envoyées à chaque itération terminée
+static void uci_report(const SearchReport &r, void *) {
+    std::ostringstream os;
+    os << "info depth " << r.depth << " seldepth " << r.seldepth
+       << " multipv " << r.multipv;
+    if (r.mate) os << " score mate " << r.mate;
+    else        os << " score cp " << r.score;
+    int t = r.time_ms > 0 ? r.time_ms : 1;
+    os << " nodes " << r.nodes
+       << " nps " << r.nodes * 1000 / t
+       << " time " << r.time_ms
+       << " tbhits " << r.stats.tb_hits
+       << " pv";
+    for (int m : r.pv) os << " " << move_to_str(m);
+    uci_send(os.str());
+}
+
+static void uci_search_worker(Position p, SearchLimits lim) {
+    int best = 0;
+    search_best_move(p, lim, best);
+
+    {
+        std::unique_lock<std::mutex> lk(uci_mtx);
+        uci_cv.wait(lk, []{ return !uci_hold; });
+    }
+
+    if (!best) {
+        int moves[256];
+        int n = generate_legal_moves(p, moves);
+        if (n == 0) { uci_send("bestmove 0000"); return; }
+        best = moves[0];
+    }
+
+    std::string out = "bestmove " + move_to_str(best);
+    std::vector<int> pv = last_report().pv;
+    if (pv.size() < 2 || pv[0] != best) pv = extract_pv(p, best, 2);
+    if (pv.size() >= 2) out += " ponder " + move_to_str(pv[1]);
+    uci_send(out);
+}
+
+// arrête la recherche en cours (s'il y en a une) et attend la fin du thread
+static void uci_stop() {
+    main_engine.stop = true;
+    {
+        std::lock_guard<std::mutex> lk(uci_mtx);
+        uci_hold = false;
+        uci_pondering = false;
+    }
+    uci_cv.notify_all();
+    if (uci_worker.joinable()) uci_worker.join();
+}
+
+// position [startpos | fen <fen>] [moves ...]
+static void uci_position(Position &pos, std::istringstream &is) {
+    std::string tok;
+    is >> tok;
+    if (tok == "startpos") {
+        start_new_game(pos);
+        is >> tok; // "moves" éventuel
+    } else if (tok == "fen") {
+        std::string fen;
+        while (is >> tok && tok != "moves") fen += tok + " ";
+        if (!set_fen(pos, fen)) {
+            uci_send("info string invalid fen");
+            start_new_game(pos);
+            return;
+        }
+        game_ply = 1;
+        game_history[0] = pos.key;
+    } else {
+        return;
+    }
+
+    if (tok != "moves") return;
+    while (is >> tok) {
+        int m = parse_move(pos, tok);
+        if (!m) {
+            uci_send("info string illegal move " + tok);
+            return;
+        }
+        apply_game_move(pos, m);
+    }
+}
+
+static void uci_go(const Position &pos, std::istringstream &is) {
+    int wtime = 0, btime = 0, winc = 0, binc = 0, movestogo = 0, movetime = 0;
+    bool infinite = false, ponder = false;
+    SearchLimits lim;
+    lim.multipv = uci_multipv;
+
+    std::string tok;
+    while (is >> tok) {
+        if      (tok == "wtime")     is >> wtime;
+        else if (tok == "btime")     is >> btime;
+        else if (tok == "winc")      is >> winc;
+        else if (tok == "binc")      is >> binc;
+        else if (tok == "movestogo") is >> movestogo;
+        else if (tok == "movetime")  is >> movetime;
+        else if (tok == "depth")     is >> lim.depth;
+        else if (tok == "nodes")     is >> lim.nodes;
+        else if (tok == "infinite")  infinite = true;
+        else if (tok == "ponder")    ponder = true;
+    }
+
+    if (movetime > 0) {
+        lim.time_ms = movetime;
+    } else {
+        lim.clock_ms  = pos.stm == WHITE ? wtime : btime;
+        lim.inc_ms    = pos.stm == WHITE ? winc : binc;
+        lim.movestogo = movestogo;
+    }
+
+    // coup du livre : réponse immédiate, sans recherche
+    if (uci_own_book && !infinite && !ponder) {
+        Position bp = pos;
+        if (int m = book_probe(bp)) {
+            uci_send("bestmove " + move_to_str(m));
+            return;
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lk(uci_mtx);
+        uci_hold = infinite || ponder;
+        uci_pondering = ponder;
+        uci_ponder_limits = lim;
+    }
+    // go infinite / ponder : aucune limite de temps tant que la GUI n'a rien dit
+    if (infinite || ponder) lim.time_ms = lim.clock_ms = 0;
+
+    main_engine.stop = false;
+    uci_worker = std::thread(uci_search_worker, pos, lim);
+}
+
+// livre ouvert sans la position initiale : clés probablement différentes
+static void uci_check_book_keys() {
+    if (!book_has_startpos(book))
+        uci_send(std::string("info string book has no entry for the start position with the ")
+                 + (poly_keys_official ? "Polyglot" : "internal") + " keys"
+                 + (poly_keys_official ? "" : "; Polyglot books need BookKeys"));
+}
+
+static void uci_setoption(std::istringstream &is) {
+    std::string tok, name, value;
+    is >> tok; // "name"
+    while (is >> tok && tok != "value") name += (name.empty() ? "" : " ") + tok;
+    std::getline(is, value);
+    std::istringstream vs(value);
+
+    if (name == "Hash") {
+        int mb = 0;
+        if (vs >> mb && mb > 0) tt_resize(mb);
+    } else if (name == "Threads") {
+        int n = 0;
+        if (vs >> n && n > 0) set_threads(n);
+    } else if (name == "MultiPV") {
+        int n = 0;
+        if (vs >> n && n >= 1) uci_multipv = std::min(n, 256);
+    } else if (name == "Clear Hash") {
+        tt_clear();
+    } else if (name == "EvalFile") {
+        std::string path;
+        std::getline(vs >> std::ws, path);
+        if (path.empty() || path == "<empty>") nnue_unload();
+        else if (!nnue_load(path)) uci_send("info string cannot load network " + path);
+        set_eval_backend(uci_want_nnue);
+    } else if (name == "SyzygyPath") {
+        std::string path;
+        std::getline(vs >> std::ws, path);
+        if (!path.empty() && path != "<empty>") {
+            if (!syzygy_init(path)) uci_send("info string syzygy unavailable (build with -DUSE_SYZYGY)");
+            else uci_send("info string syzygy tables up to " + std::to_string(tb_largest()) + " pieces");
+        }
+    } else if (name == "SyzygyProbeDepth") {
+        int n = 0;
+        if (vs >> n && n >= 1) tb_probe_depth = n;
+    } else if (name == "OwnBook") {
+        std::string v;
+        vs >> v;
+        uci_own_book = v == "true";
+    } else if (name == "BookFile") {
+        std::string path;
+        std::getline(vs >> std::ws, path);
+        if (path.empty() || path == "<empty>") book_close(book);
+        else if (!book_open(book, path)) uci_send("info string cannot open book " + path);
+        else uci_check_book_keys();
+    } else if (name == "BookDepth") {
+        int n = 0;
+        if (vs >> n && n >= 0) book.max_ply = n;
+    } else if (name == "BookBestMove") {
+        std::string v;
+        vs >> v;
+        book.best = v == "true";
+    } else if (name == "BookKeys") {
+        std::string path;
+        std::getline(vs >> std::ws, path);
+        if (!book_load_keys(path)) uci_send("info string cannot read book keys " + path + " (not the Polyglot Random64 table)");
+        else if (book.data) uci_check_book_keys();
+    } else if (name == "UseNNUE") {
+        std::string v;
+        vs >> v;
+        uci_want_nnue = v == "true";
+        if (!set_eval_backend(uci_want_nnue))
+            uci_send("info string no network loaded, using classical eval");
+    }
+    // "Ponder" : rien à faire, la GUI décide d'envoyer "go ponder"
+}
+
+// uciAlreadyRead : la commande "uci" a déjà été lue par le menu interactif
+inline int uci_loop(bool uciAlreadyRead = false) {
+    if (get_threads() == 0) set_threads(1);
+    if (!TT.buckets) tt_resize(TT_DEFAULT_MB);
+    main_engine.reporter = uci_report;
+
+    Position pos;
+    start_new_game(pos);
+
+    std::string line = uciAlreadyRead ? "uci" : "";
+    if (!uciAlreadyRead && !std::getline(std::cin, line)) line = "quit";
+
+    while (true) {
+        std::istringstream is(line);
+        std::string cmd;
+        is >> cmd;
+
+        if (cmd == "uci") {
+            uci_send("id name CEChess");
+            uci_send("id author reikland");
+            uci_send("option name Hash type spin default " + std::to_string(TT_DEFAULT_MB) + " min 1 max 65536");
+            uci_send("option name Threads type spin default 1 min 1 max 256");
+            uci_send("option name Ponder type check default false");
+            uci_send("option name MultiPV type spin default 1 min 1 max 256");
+            uci_send("option name Clear Hash type button");
+            uci_send("option name EvalFile type string default <empty>");
+            uci_send("option name UseNNUE type check default false");
+            uci_send("option name SyzygyPath type string default <empty>");
+            uci_send("option name SyzygyProbeDepth type spin default 1 min 1 max 100");
+            uci_send("option name OwnBook type check default false");
+            uci_send("option name BookFile type string default <empty>");
+            uci_send("option name BookDepth type spin default " + std::to_string(BOOK_DEFAULT_PLY) + " min 0 max 1000");
+            uci_send("option name BookBestMove type check default false");
+            uci_send("option name BookKeys type string default <empty>");
+            uci_send("uciok");
+        } else if (cmd == "isready") {
+            uci_send("readyok");
+        } else if (cmd == "setoption") {
+            uci_stop();
+            uci_setoption(is);
+        } else if (cmd == "ucinewgame") {
+            uci_stop();
+            tt_clear();
+            start_new_game(pos);
+        } else if (cmd == "position") {
+            uci_stop();
+            uci_position(pos, is);
+        } else if (cmd == "go") {
+            uci_stop();
+            uci_go(pos, is);
+        } else if (cmd == "stop") {
+            uci_stop();
+        } else if (cmd == "ponderhit") {
+            {
+                std::lock_guard<std::mutex> lk(uci_mtx);
+                if (uci_pondering) {
+                    uci_pondering = false;
+                    uci_hold = false;
+                    const SearchLimits &l = uci_ponder_limits;
+                    if (l.clock_ms > 0) {
+                        int soft, hard;
+                        time_allocate(l, soft, hard);
+                        set_time_budget(soft, hard);
+                    } else {
+                        set_search_time(l.time_ms);
+                    }
+                }
+            }
+            uci_cv.notify_all();
+        } else if (cmd == "quit") {
+            uci_stop();
+            break;
+        }
+
+        if (!std::getline(std::cin, line)) line = "quit";
+    }
+
+    main_engine.reporter = nullptr;
+    return 0;
+}
+
+} // namespace cechess